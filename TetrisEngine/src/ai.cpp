@@ -1,5 +1,8 @@
 #include "ai.h"
+#include "featurekernels.h"
 
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <cmath>
 
@@ -7,14 +10,57 @@
 
 namespace {
 
-	// Calculate and return all possible states for the block provided.
-	std::vector<Ai::State> calculateAllPossibleStates(const RawTetrisBoard& board, Block block) {
-		std::vector<Ai::State> states;
-		
+	// The variables available in the value function, the index in the feature array.
+	enum Feature {
+		ROW_HOLES,
+		COLUMN_HOLES,
+		EDGES,
+		ROW_SUM_HEIGHT,
+		BLOCK_MEAN_HEIGHT,
+		BUMPINESS,
+		ROWS,
+		COLUMNS,
+		NBR_OF_FEATURES
+	};
+
+	// Same order as Feature.
+	const std::vector<std::string> FEATURE_NAMES = {
+		"rowHoles",
+		"columnHoles",
+		"edges",
+		"rowSumHeight",
+		"blockMeanHeight",
+		"bumpiness",
+		"rows",
+		"columns"
+	};
+
+	const std::array<BlockType, 7> BLOCK_TYPES = {
+		BlockType::I, BlockType::J, BlockType::L, BlockType::O, BlockType::S, BlockType::T, BlockType::Z
+	};
+
+	// The max number of states for a block, all rotations in all columns.
+	const int MAX_STATES = 4 * BitBoard::MAX_COLUMNS;
+
+	// Return the key for a search on the board, the value of the search depends on
+	// all the parameters.
+	std::uint64_t calculateSearchKey(const BitBoard& board, BlockType current, BlockType next, int rows, int depth) {
+		std::uint64_t parameters = (std::uint64_t) current;
+		parameters = parameters << 8 | (std::uint64_t) next;
+		parameters = parameters << 8 | (std::uint64_t) depth;
+		parameters = parameters << 16 | (std::uint64_t) rows;
+		parameters = parameters << 16 | (std::uint64_t) board.getColumns();
+		return board.getHash() ^ BitBoard::mixHash(parameters);
+	}
+
+	// Call the function with all possible states for the block provided.
+	template <class Function>
+	void forEachPossibleState(const BitBoard& board, Block block, Function&& function) {
 		// Valid block position?
 		if (!board.collision(block)) {
 			// Go through all rotations for the block.
-			for (int rotationLeft = 0; rotationLeft <= block.getNumberOfRotations(); ++rotationLeft, block.rotateLeft()) {
+			const int orientations = Block::getNumberOfOrientations(block.getBlockType());
+			for (int rotationLeft = 0; rotationLeft < orientations; ++rotationLeft, block.rotateLeft()) {
 				// Go left.
 				Block horizontal = block;
 				horizontal.moveLeft();
@@ -22,14 +68,7 @@ namespace {
 				int stepsLeft = 1;
 				// Go left until obstacle.
 				while (!board.collision(horizontal)) {
-					Block vertical = horizontal;
-					int stepsDown = 1;
-					vertical.moveDown();
-					while (!board.collision(vertical)) {
-						++stepsDown;
-						vertical.moveDown();
-					}
-					states.emplace_back(stepsLeft, rotationLeft);
+					function(Ai::State(stepsLeft, rotationLeft));
 
 					++stepsLeft;
 					horizontal.moveLeft();
@@ -40,93 +79,64 @@ namespace {
 				horizontal = block;
 				// Go right until obstacle.
 				while (!board.collision(horizontal)) {
-					Block vertical = horizontal;
-					int stepsDown = 1;
-					vertical.moveDown();
-					while (!board.collision(vertical)) {
-						++stepsDown;
-						vertical.moveDown();
-					}
-					states.emplace_back(stepsLeft, rotationLeft);
+					function(Ai::State(stepsLeft, rotationLeft));
 
 					--stepsLeft;
 					horizontal.moveRight();
 				}
 			}
 		}
-		return states;
-	}	
+	}
 
-	struct RowRoughness {
-		RowRoughness() : holes_(0), rowSum_(0) {
+	// Move the block to the state and down to the ground. The moves are done the
+	// same way as when ROTATE_LEFT, LEFT, RIGHT and DOWN_GROUND updates a RawTetrisBoard.
+	Block moveBlock(const BitBoard& board, Block block, const Ai::State& state) {
+		for (int i = 0; i < state.rotationLeft_; ++i) {
+			Block rotated = block;
+			rotated.rotateLeft();
+			if (!board.collision(rotated)) {
+				block = rotated;
+			}
 		}
-
-		int holes_;
-		int rowSum_;
-	};
-
-	RowRoughness calculateRowRoughness(const RawTetrisBoard& board, int highestUsedRow) {
-		RowRoughness rowRoughness;
-		int holes = 0;
-		for (int row = 0; row < highestUsedRow; ++row) {
-			bool lastHole = board.getBlockType(row, 0) == BlockType::EMPTY;
-			for (int column = 1; column < board.getColumns(); ++column) {
-				bool hole = board.getBlockType(row, column) == BlockType::EMPTY;
-				if (lastHole != hole) {
-					rowRoughness.holes_ += 1;
-					lastHole = hole;
-				}
-				if (!hole) {
-					rowRoughness.rowSum_ += row;
-					++holes;
-				}
+		for (int i = 0; i < std::abs(state.left_); ++i) {
+			Block moved = block;
+			state.left_ > 0 ? moved.moveLeft() : moved.moveRight();
+			if (!board.collision(moved)) {
+				block = moved;
 			}
 		}
-		return rowRoughness;
+		int distance = board.getDropDistance(block);
+		for (int i = 0; i < distance; ++i) {
+			block.moveDown();
+		}
+		return block;
 	}
 
-	struct ColumnRoughness {
-		ColumnRoughness() : holes_(0), bumpiness(0) {
+	// Add the block to the board and remove the filled rows, the same way as a RawTetrisBoard.
+	void addBlockToBoard(BitBoard& board, const Block& block, int rows) {
+		for (const Square& sq : block) {
+			board.set(sq.row_, sq.column_);
 		}
-
-		int holes_;
-		int bumpiness;
-	};
-
-	ColumnRoughness calculateColumnHoles(const RawTetrisBoard& board, int highestUsedRow) {
-		ColumnRoughness roughness;
-		int lastColumnNbr;
-		for (int column = 0; column < board.getColumns(); ++column) {
-			bool lastHole = board.getBlockType(0, column) == BlockType::EMPTY;
-			int columnNbr = lastHole ? 0 : 1;
-			for (int row = 1; row < highestUsedRow; ++row) {
-				bool hole = board.getBlockType(row, column) == BlockType::EMPTY;
-				if (lastHole != hole) {
-					roughness.holes_ += 1;
-					lastHole = hole;
-				}
-				if (!hole) {
-					++columnNbr;
-				}
-			}
-			if (column != 0) {
-				roughness.bumpiness += std::abs(lastColumnNbr - columnNbr);
+		int row = block.getLowestRow();
+		for (int i = 0; i < block.getSize(); ++i) {
+			if (row >= 0 && row < board.getHeight() && board.isRowFilled(row)) {
+				board.removeRow(row, rows);
+			} else {
+				++row;
 			}
-			lastColumnNbr = columnNbr;
 		}
-		return roughness;
 	}
 
-	int calculateHighestUsedRow(const RawTetrisBoard& board) {
-		auto v = board.getBoardVector();
-		int index = 0;
-		for (auto it = v.rbegin(); it != v.rend(); ++it) {
-			if (*it != BlockType::EMPTY) {
-				index = it - v.rbegin();
-				break;
-			}
-		}
-		return (v.size() - index - 1) / board.getColumns() + 2;
+	// Return the sum of the row index for all occupied squares, the first column excluded.
+	int calculateRowSumHeight(const BitBoard& board) {
+		const BitBoard::Row firstColumn = 1;
+		return FeatureKernels::weightedBitCount(board.getRowData(), board.getHighestColumnHeight(), ~firstColumn);
+	}
+
+	// Return the sum of the height differences between adjacent columns, where the
+	// height is the number of occupied squares in the column.
+	int calculateBumpiness(const BitBoard& board) {
+		return FeatureKernels::adjacentDifferenceSum(board.getColumnSquareData(), board.getColumns());
 	}
 
 	float calculateBlockMeanHeight(const Block& block) {
@@ -137,30 +147,27 @@ namespace {
 		return (float) blockMeanHeight / block.getSize();
 	}
 
-	int calculateBlockEdges(const RawTetrisBoard& board, const Block& block) {
+	int calculateBlockEdges(const BitBoard& board, const Block& block) {
 		int edges = 0;
 		for (const Square& sq : block) {
-			board.getBlockType(sq.row_, sq.column_ - 1) != BlockType::EMPTY ? ++edges : 0;
-			board.getBlockType(sq.row_ - 1, sq.column_) != BlockType::EMPTY ? ++edges : 0;
-			board.getBlockType(sq.row_, sq.column_ + 1) != BlockType::EMPTY ? ++edges : 0;
+			board.isOccupied(sq.row_, sq.column_ - 1) ? ++edges : 0;
+			board.isOccupied(sq.row_ - 1, sq.column_) ? ++edges : 0;
+			board.isOccupied(sq.row_, sq.column_ + 1) ? ++edges : 0;
 		}
 		return edges;
 	}
 
-	float calculateValue(calc::Calculator& calculator, const calc::Cache& cache, const RawTetrisBoard& board, const Block& block) {
-		int highestUsedRow = calculateHighestUsedRow(board);
-		RowRoughness rowRoughness = calculateRowRoughness(board, highestUsedRow);
-		ColumnRoughness columnRoughness = calculateColumnHoles(board, highestUsedRow);
-		int edges = calculateBlockEdges(board, block);
-		float blockMeanHeight = calculateBlockMeanHeight(block);
-		
-		calculator.updateVariable("rowHoles", (float) rowRoughness.holes_);
-		calculator.updateVariable("columnHoles", (float) columnRoughness.holes_);
-		calculator.updateVariable("bumpiness", (float) columnRoughness.bumpiness);
-		calculator.updateVariable("edges", (float) edges);
-		calculator.updateVariable("rowSumHeight", (float) rowRoughness.rowSum_);
-		calculator.updateVariable("blockMeanHeight", blockMeanHeight);
-		return calculator.excecute(cache);
+	// The board features are updated incrementally by the bit board, the only full
+	// scan left is the row sum which is a bit count for each used row.
+	void calculateFeatures(const BitBoard& board, const Block& block, int rows, float* features) {
+		features[ROW_HOLES] = (float) board.getRowTransitions();
+		features[COLUMN_HOLES] = (float) board.getColumnTransitions();
+		features[EDGES] = (float) calculateBlockEdges(board, block);
+		features[ROW_SUM_HEIGHT] = (float) calculateRowSumHeight(board);
+		features[BLOCK_MEAN_HEIGHT] = calculateBlockMeanHeight(block);
+		features[BUMPINESS] = (float) calculateBumpiness(board);
+		features[ROWS] = (float) rows;
+		features[COLUMNS] = (float) board.getColumns();
 	}
 
 } // Anonymous namespace.
@@ -174,76 +181,302 @@ Ai::State::State(int left, int rotations) : left_(left), rotationLeft_(rotations
 Ai::Ai() : Ai("DefaultAi", "-2*rowHoles - 5*columnHoles - 1*rowSumHeight / (1 + rowHoles) - 2*blockMeanHeight") {
 }
 
-Ai::Ai(std::string name, std::string valueFunction) : name_(name), valueFunction_(valueFunction) {
+Ai::Ai(std::string name, std::string valueFunction) : name_(name), valueFunction_(valueFunction),
+	searchMode_(SearchMode::EXHAUSTIVE), beamWidth_(16), timeBudget_(0), depth_(0) {
+
 	initCalculator();
 }
 
-Ai::State Ai::calculateBestState(RawTetrisBoard board, int depth) {
-	calculator_.updateVariable("rows", (float) board.getRows());
-	calculator_.updateVariable("columns", (float) board.getColumns());
-	return calculateBestStateRecursive(board, depth);
+void Ai::calculateAllPossibleStates(const BitBoard& board, const Block& block, std::vector<State>& states) {
+	states.clear();
+	forEachPossibleState(board, block, [&](const State& state) {
+		states.push_back(state);
+	});
+}
+
+Ai::State Ai::calculateBestState(const RawTetrisBoard& board, int depth) {
+	if (board.isGameOver()) {
+		return State();
+	}
+	if (searchMode_ != SearchMode::EXHAUSTIVE || timeBudget_ > 0) {
+		if (!searchCache_.threadPool_) {
+			// A pool without workers, i.e. all is done by the calling thread.
+			searchCache_.threadPool_ = std::make_unique<ThreadPool>(0);
+		}
+		if (!searchCache_.workspace_) {
+			searchCache_.workspace_ = std::make_unique<Workspace>(createWorkspace(*searchCache_.threadPool_));
+		}
+		return calculateBestState(board.getBitBoard(), board.getBlock(), board.getNextBlockType(), board.getRows(), depth,
+			*searchCache_.threadPool_, *searchCache_.workspace_);
+	}
+	TranspositionTable::Counters counters;
+	return calculateBestStateRecursive(board.getBitBoard(), board.getBlock(), board.getNextBlockType(), board.getRows(), depth,
+		calculator_, nullptr, counters);
+}
+
+Ai::Workspace Ai::createWorkspace(const ThreadPool& threadPool) const {
+	Workspace workspace;
+	workspace.calculators_.assign(threadPool.getNbrOfWorkers() + 1, calculator_);
+	workspace.tableCounters_.resize(workspace.calculators_.size());
+	// Room for all states of a block on a board with the max number of columns.
+	workspace.states_.reserve(MAX_STATES);
+	workspace.transpositionTable_ = std::make_unique<TranspositionTable>(TRANSPOSITION_TABLE_SIZE_LOG2);
+	if (searchMode_ == SearchMode::BEAM) {
+		workspace.beam_.reserve(beamWidth_);
+		workspace.nextBeam_.reserve(beamWidth_);
+		workspace.candidates_.reserve(beamWidth_ * MAX_STATES);
+		workspace.candidateCounts_.reserve(beamWidth_);
+	}
+	return workspace;
+}
+
+TranspositionTable::Counters Ai::Workspace::getTableCounters() const {
+	TranspositionTable::Counters sum;
+	for (const TranspositionTable::Counters& counters : tableCounters_) {
+		sum += counters;
+	}
+	return sum;
+}
+
+Ai::State Ai::calculateBestState(const RawTetrisBoard& board, int depth, ThreadPool& threadPool) const {
+	if (board.isGameOver()) {
+		return State();
+	}
+	Workspace workspace = createWorkspace(threadPool);
+	return calculateBestState(board.getBitBoard(), board.getBlock(), board.getNextBlockType(), board.getRows(), depth, threadPool, workspace);
+}
+
+Ai::State Ai::calculateBestState(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+	ThreadPool& threadPool, Workspace& workspace) const {
+
+	if (timeBudget_ > 0) {
+		const std::atomic<bool> stop(false);
+		return calculateBestState(board, current, next, rows, depth, threadPool, workspace,
+			Clock::now() + std::chrono::milliseconds(timeBudget_), stop, nullptr);
+	}
+	const SearchLimit noLimit{Clock::time_point::max(), nullptr};
+	if (searchMode_ == SearchMode::BEAM) {
+		return calculateBestStateBeam(board, current, next, rows, depth, noLimit, nullptr, threadPool, workspace);
+	}
+	State bestState;
+	if (depth > 0) {
+		calculateBestStateAtDepth(board, current, next, rows, depth, noLimit, threadPool, workspace, bestState);
+	}
+	return bestState;
+}
+
+Ai::State Ai::calculateBestState(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+	ThreadPool& threadPool, Workspace& workspace, Clock::time_point deadline, const std::atomic<bool>& stop,
+	const ProgressCallback& callback) const {
+
+	const SearchLimit limit{deadline, &stop};
+	if (searchMode_ == SearchMode::BEAM) {
+		// Each ply in the beam search is a completed depth.
+		return calculateBestStateBeam(board, current, next, rows, depth, limit, callback, threadPool, workspace);
+	}
+	State bestState;
+	for (int iterationDepth = 1; iterationDepth <= depth; ++iterationDepth) {
+		State state;
+		if (!calculateBestStateAtDepth(board, current, next, rows, iterationDepth, limit, threadPool, workspace, state)) {
+			// Not completed, use the result from the previous depth.
+			break;
+		}
+		bestState = state;
+		if (callback) {
+			callback(bestState, iterationDepth);
+		}
+	}
+	return bestState;
+}
+
+bool Ai::calculateBestStateAtDepth(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+	const SearchLimit& limit, ThreadPool& threadPool, Workspace& workspace, State& bestState) const {
+
+	std::vector<State>& states = workspace.states_;
+	states.clear();
+	forEachPossibleState(board, current, [&](const State& state) {
+		states.push_back(state);
+	});
+
+	// Each root state and its subtree is a task.
+	std::atomic<bool> interrupted(false);
+	threadPool.parallelFor(states.size(), [&](int index) {
+		if (interrupted || limit.isReached()) {
+			interrupted = true;
+			return;
+		}
+		const int workerIndex = threadPool.getWorkerIndex() + 1;
+		TranspositionTable::Counters counters;
+		states[index].value_ = calculateStateValue(board, current, next, rows, depth, states[index],
+			workspace.calculators_[workerIndex], workspace.transpositionTable_.get(), counters);
+		workspace.tableCounters_[workerIndex] += counters;
+	});
+	if (interrupted) {
+		return false;
+	}
+
+	// Same order as the serial search, i.e. the first of equally good states is chosen.
+	bestState = State();
+	for (const State& state : states) {
+		if (state.value_ > bestState.value_) {
+			bestState = state;
+		}
+	}
+	return true;
+}
+
+Ai::State Ai::calculateBestStateBeam(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+	const SearchLimit& limit, const ProgressCallback& callback, ThreadPool& threadPool, Workspace& workspace) const {
+
+	using BeamCandidate = Workspace::BeamCandidate;
+	std::vector<Workspace::BeamNode>& beam = workspace.beam_;
+	std::vector<Workspace::BeamNode>& nextBeam = workspace.nextBeam_;
+	std::vector<BeamCandidate>& candidates = workspace.candidates_;
+	std::vector<int>& counts = workspace.candidateCounts_;
+
+	beam.resize(1);
+	beam[0].board_ = board;
+	beam[0].root_ = State();
+	State bestState;
+
+	for (int ply = 0; ply < depth; ++ply) {
+		if (ply > 0 && limit.isReached()) {
+			break;
+		}
+		const Block block = ply == 0 ? current : RawTetrisBoard::createStartBlock(next, rows, board.getColumns());
+
+		// All placements for each board in the beam, each board is a task.
+		candidates.resize(beam.size() * MAX_STATES);
+		counts.assign(beam.size(), 0);
+		threadPool.parallelFor(beam.size(), [&](int index) {
+			calc::Calculator& calculator = workspace.calculators_[threadPool.getWorkerIndex() + 1];
+			const BitBoard& nodeBoard = beam[index].board_;
+			int count = 0;
+			TranspositionTable::Counters counters; // Unused, no table.
+			forEachPossibleState(nodeBoard, block, [&](const State& state) {
+				BeamCandidate& candidate = candidates[index * MAX_STATES + count++];
+				candidate.parent_ = index;
+				candidate.state_ = state;
+				candidate.state_.value_ = calculateStateValue(nodeBoard, block, next, rows, 1, state, calculator, nullptr, counters);
+			});
+			counts[index] = count;
+		});
+
+		int size = 0;
+		for (int index = 0; index < (int) beam.size(); ++index) {
+			for (int i = 0; i < counts[index]; ++i) {
+				candidates[size] = candidates[index * MAX_STATES + i];
+				candidates[size].order_ = size;
+				++size;
+			}
+		}
+		if (size == 0) {
+			// Game over for all boards.
+			break;
+		}
+
+		// Keep the best candidates, equal values in order for a deterministic result.
+		const int width = std::min(size, beamWidth_);
+		std::partial_sort(candidates.begin(), candidates.begin() + width, candidates.begin() + size,
+			[](const BeamCandidate& a, const BeamCandidate& b) {
+			return a.state_.value_ > b.state_.value_ || (a.state_.value_ == b.state_.value_ && a.order_ < b.order_);
+		});
+		bestState = ply == 0 ? candidates[0].state_ : beam[candidates[0].parent_].root_;
+		bestState.value_ = candidates[0].state_.value_;
+		if (callback) {
+			callback(bestState, ply + 1);
+		}
+
+		nextBeam.resize(width);
+		threadPool.parallelFor(width, [&](int index) {
+			const BeamCandidate& candidate = candidates[index];
+			const Workspace::BeamNode& parent = beam[candidate.parent_];
+			nextBeam[index].board_ = parent.board_;
+			addBlockToBoard(nextBeam[index].board_, moveBlock(parent.board_, block, candidate.state_), rows);
+			nextBeam[index].root_ = ply == 0 ? candidate.state_ : parent.root_;
+		});
+		std::swap(beam, nextBeam);
+	}
+	return bestState;
 }
 
 // Find the best state for the block to move.
-Ai::State Ai::calculateBestStateRecursive(RawTetrisBoard board, int depth) {
+Ai::State Ai::calculateBestStateRecursive(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+	calc::Calculator& calculator, TranspositionTable* transpositionTable, TranspositionTable::Counters& counters) const {
+
 	Ai::State bestState;
 
 	if (depth != 0) {
-		std::vector<Ai::State> states = calculateAllPossibleStates(board, board.getBlock());
+		forEachPossibleState(board, current, [&](const Ai::State& state) {
+			float value = calculateStateValue(board, current, next, rows, depth, state, calculator, transpositionTable, counters);
+			if (value > bestState.value_) {
+				bestState = state;
+				bestState.value_ = value;
+			}
+		});
+	}
+	return bestState;
+}
 
-		for (const Ai::State state : states) {
-			RawTetrisBoard childBoard = board;
+float Ai::calculateStateValue(const BitBoard& board, const Block& current, BlockType next, int rows, int depth, const State& state,
+	calc::Calculator& calculator, TranspositionTable* transpositionTable, TranspositionTable::Counters& counters) const {
 
-			// Rotate.
-			for (int i = 0; i < state.rotationLeft_; ++i) {
-				childBoard.update(Move::ROTATE_LEFT);
-			}
-			
-			// Move left.
-			for (int i = 0; i < state.left_; ++i) {
-				childBoard.update(Move::LEFT);
-			}
-			// Move right.
-			for (int i = 0; i < -1 * state.left_; ++i) {
-				childBoard.update(Move::RIGHT);
-			}
+	// Move down the block and stop just before impact.
+	Block block = moveBlock(board, current, state);
 
-			// Move down the block and stop just before impact.
-			childBoard.update(Move::DOWN_GROUND);
-			// Save the current block before impact.
-			Block block = childBoard.getBlock();
-			// Impact, the block is now a part of the board.
-			childBoard.update(Move::DOWN_GRAVITY);
+	// Impact, the block is now a part of the board.
+	BitBoard childBoard = board;
+	addBlockToBoard(childBoard, block, rows);
 
-			if (depth > 1) {
-				State childState = calculateBestState(childBoard, depth - 1);
+	if (depth > 1) {
+		// The blocks after the next block are unknown, EMPTY is used for an unknown block.
+		const BlockType childNext = searchMode_ == SearchMode::EXPECTIMAX ? BlockType::EMPTY : next;
 
-				if (childState.value_ > bestState.value_) {
-					bestState = state;
-					// Only updating the value from the child.
-					bestState.value_ = childState.value_;
-				}
-			} else {
-				float value = calculateValue(calculator_, cache_, childBoard, block);
-				if (value > bestState.value_) {
-					bestState = state;
-					bestState.value_ = value;
-				}
+		// The same board can be reached by placing the blocks in different orders.
+		std::uint64_t key = 0;
+		float value;
+		if (transpositionTable != nullptr) {
+			key = calculateSearchKey(childBoard, next, childNext, rows, depth - 1);
+			if (transpositionTable->find(key, value, counters)) {
+				return value;
 			}
 		}
+		if (next == BlockType::EMPTY) {
+			// The mean value over all possible blocks.
+			value = 0;
+			for (BlockType blockType : BLOCK_TYPES) {
+				Block childBlock = RawTetrisBoard::createStartBlock(blockType, rows, board.getColumns());
+				value += calculateBestStateRecursive(childBoard, childBlock, childNext, rows, depth - 1, calculator, transpositionTable, counters).value_ / BLOCK_TYPES.size();
+			}
+		} else {
+			Block childBlock = RawTetrisBoard::createStartBlock(next, rows, board.getColumns());
+			// Only the value from the child is used.
+			value = calculateBestStateRecursive(childBoard, childBlock, childNext, rows, depth - 1, calculator, transpositionTable, counters).value_;
+		}
+		if (transpositionTable != nullptr) {
+			transpositionTable->insert(key, value);
+		}
+		return value;
 	}
-	return bestState;
+	float features[NBR_OF_FEATURES];
+	calculateFeatures(childBoard, block, rows, features);
+	if (compiledFunction_.isValid()) {
+		return compiledFunction_.calculate(features);
+	}
+
+	// Expression not supported by the compiled function.
+	for (int i = 0; i < NBR_OF_FEATURES; ++i) {
+		calculator.updateVariable(FEATURE_NAMES[i], features[i]);
+	}
+	return calculator.excecute(cache_);
 }
 
 void Ai::initCalculator() {
-	calculator_.addVariable("rowHoles", 0);
-	calculator_.addVariable("columnHoles", 0);
-	calculator_.addVariable("edges", 0);
-	calculator_.addVariable("rowSumHeight", 0);
-	calculator_.addVariable("blockMeanHeight", 0);
-	calculator_.addVariable("bumpiness", 0);
-
-	calculator_.addVariable("rows", 0);
-	calculator_.addVariable("columns", 0);
+	for (const std::string& name : FEATURE_NAMES) {
+		calculator_.addVariable(name, 0);
+	}
 	cache_ = calculator_.preCalculate(valueFunction_);
+	if (!calculator_.hasError()) {
+		compiledFunction_.compile(valueFunction_, FEATURE_NAMES);
+	}
 }
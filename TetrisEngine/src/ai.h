@@ -2,14 +2,31 @@
 #define AI_H
 
 #include "rawtetrisboard.h"
+#include "threadpool.h"
+#include "transpositiontable.h"
+#include "valuefunction.h"
 
 #include <calc/calculator.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 class Ai {
 public:
+	// How the placements are searched.
+	enum class SearchMode {
+		EXHAUSTIVE,	// All placements, the blocks after the next block are assumed to be the next block.
+		BEAM,		// Only the best boards after each block are searched further, the blocks after the next block are assumed to be the next block.
+		EXPECTIMAX	// All placements, the value for the blocks after the next block is the mean over all block types.
+	};
+
+	using Clock = std::chrono::steady_clock;
+
 	Ai();
 
 	Ai(std::string name, std::string valueFunction);
@@ -29,6 +46,45 @@ public:
 	const calc::Cache& getCache() {
 		return cache_;
 	}
+
+	SearchMode getSearchMode() const {
+		return searchMode_;
+	}
+
+	void setSearchMode(SearchMode searchMode) {
+		searchMode_ = searchMode;
+		searchCache_.workspace_.reset();
+	}
+
+	// The number of boards kept after each block in beam search.
+	int getBeamWidth() const {
+		return beamWidth_;
+	}
+
+	void setBeamWidth(int beamWidth) {
+		beamWidth_ = std::max(1, beamWidth);
+		searchCache_.workspace_.reset();
+	}
+
+	// The max time in milliseconds for one search, zero means no limit. With a
+	// limit the search is iterative, and when the time is up the best state from
+	// the deepest completed depth is returned.
+	int getTimeBudget() const {
+		return timeBudget_;
+	}
+
+	void setTimeBudget(int timeBudget) {
+		timeBudget_ = std::max(0, timeBudget);
+	}
+
+	// The number of blocks to look ahead, zero means the caller decides.
+	int getDepth() const {
+		return depth_;
+	}
+
+	void setDepth(int depth) {
+		depth_ = std::max(0, depth);
+	}
 	
 	struct State {
 		State();
@@ -40,18 +96,131 @@ public:
 		float value_;
 	};
 
-	State calculateBestState(RawTetrisBoard board, int depth);
+	// Preallocated memory for the search in a thread pool, i.e. one calculator for
+	// each worker and one for the calling thread. The transposition table is shared
+	// by all threads and keeps the values of the searched positions between searches.
+	// The lookups in the table are counted by each thread on its own.
+	struct Workspace {
+		// A board kept in the beam search and the root state it comes from.
+		struct BeamNode {
+			BitBoard board_;
+			State root_;
+		};
+
+		// A placement of the block on the board in a beam node.
+		struct BeamCandidate {
+			int parent_;
+			int order_;
+			State state_;
+		};
+
+		// Return the lookups in the transposition table by all threads, since the
+		// workspace was created.
+		TranspositionTable::Counters getTableCounters() const;
+
+		std::vector<calc::Calculator> calculators_;
+		std::vector<TranspositionTable::Counters> tableCounters_; // The same index as the calculators.
+		std::vector<State> states_;
+		std::unique_ptr<TranspositionTable> transpositionTable_;
+		std::vector<BeamNode> beam_, nextBeam_;
+		std::vector<BeamCandidate> candidates_;
+		std::vector<int> candidateCounts_;
+	};
+
+	// The number of entries in the transposition table, as a power of two.
+	static const int TRANSPOSITION_TABLE_SIZE_LOG2 = 16;
+
+	Workspace createWorkspace(const ThreadPool& threadPool) const;
+
+	// Replace the states with all placements for the block on the board, i.e. the
+	// root states searched by calculateBestState.
+	static void calculateAllPossibleStates(const BitBoard& board, const Block& block, std::vector<State>& states);
+
+	// Return the best state for the current block on the board. The search looks
+	// depth blocks ahead, i.e. the current block and (if depth > 1) the next block.
+	// The board is only read, all placements are done on copies of its bit board.
+	// Other than the exhaustive search without time budget, the search is done in a
+	// workspace kept by the ai between the calls.
+	State calculateBestState(const RawTetrisBoard& board, int depth);
+
+	// Same as above, but the states for the current block (and their subtrees) are
+	// calculated as tasks in the thread pool. The result is the same as for the serial search.
+	State calculateBestState(const RawTetrisBoard& board, int depth, ThreadPool& threadPool) const;
+
+	// Same as above, but the search starts from the current block on the bit board
+	// and reuses the memory in the workspace, i.e. the board is assumed not to be game over.
+	State calculateBestState(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+		ThreadPool& threadPool, Workspace& workspace) const;
+
+	// Called with the best state each time a search depth is completed.
+	using ProgressCallback = std::function<void(const State& state, int depth)>;
+
+	// Same as above, but the search is iterative, i.e. done for depth 1, 2, ... up to
+	// depth. The search stops when the deadline has passed or stop is set, then the
+	// best state from the deepest completed depth is returned. The callback may be null.
+	State calculateBestState(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+		ThreadPool& threadPool, Workspace& workspace, Clock::time_point deadline, const std::atomic<bool>& stop,
+		const ProgressCallback& callback) const;
 	
 private:
+	// The thread pool and the workspace for calculateBestState(board, depth), created by
+	// the first search and kept to reuse the memory and the transposition table. Not
+	// copied with the ai.
+	struct SearchCache {
+		SearchCache() = default;
+
+		SearchCache(const SearchCache&) {
+		}
+
+		SearchCache& operator=(const SearchCache&) {
+			workspace_.reset();
+			threadPool_.reset();
+			return *this;
+		}
+
+		std::unique_ptr<ThreadPool> threadPool_;
+		std::unique_ptr<Workspace> workspace_;
+	};
+
+	// When to stop searching, stop may be null.
+	struct SearchLimit {
+		Clock::time_point deadline_;
+		const std::atomic<bool>* stop_;
+
+		bool isReached() const {
+			return (stop_ != nullptr && *stop_) || Clock::now() > deadline_;
+		}
+	};
+
 	void initCalculator();
+
+	// Search all root states to the depth. Return false if the limit was reached
+	// before all states were searched, then the best state is not set.
+	bool calculateBestStateAtDepth(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+		const SearchLimit& limit, ThreadPool& threadPool, Workspace& workspace, State& bestState) const;
+
+	State calculateBestStateBeam(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+		const SearchLimit& limit, const ProgressCallback& callback, ThreadPool& threadPool, Workspace& workspace) const;
 	
-	State calculateBestStateRecursive(RawTetrisBoard board, int depth);
+	// The transposition table is optional, i.e. may be null.
+	State calculateBestStateRecursive(const BitBoard& board, const Block& current, BlockType next, int rows, int depth,
+		calc::Calculator& calculator, TranspositionTable* transpositionTable, TranspositionTable::Counters& counters) const;
+
+	// Return the value of the board when the current block is moved to the state.
+	float calculateStateValue(const BitBoard& board, const Block& current, BlockType next, int rows, int depth, const State& state,
+		calc::Calculator& calculator, TranspositionTable* transpositionTable, TranspositionTable::Counters& counters) const;
 
 	std::string name_;
 	std::string valueFunction_;
 
 	calc::Calculator calculator_;
 	calc::Cache cache_;
+	ValueFunction compiledFunction_;
+	SearchMode searchMode_;
+	int beamWidth_;
+	int timeBudget_;
+	int depth_;
+	SearchCache searchCache_;
 };
 
 #endif // AI_H
@@ -0,0 +1,96 @@
+#include "aiservice.h"
+
+#include <chrono>
+
+AiService::AiService(int workers) : threadPool_(std::make_shared<ThreadPool>(workers)) {
+}
+
+AiService::Handle AiService::createHandle(const Ai& ai) const {
+	return Handle(ai, threadPool_);
+}
+
+AiService::Handle::Job::Job(const Ai& ai, ThreadPool& threadPool) : threadPool_(threadPool), ai_(ai),
+	workspace_(ai.createWorkspace(threadPool)), next_(BlockType::EMPTY), rows_(0), depth_(0), done_(true), stop_(false),
+	bestDepth_(0) {
+}
+
+AiService::Handle::Handle() : active_(false) {
+}
+
+AiService::Handle::Handle(const Ai& ai, const std::shared_ptr<ThreadPool>& threadPool) : threadPool_(threadPool),
+	job_(std::make_shared<Job>(ai, *threadPool)), active_(false) {
+}
+
+const Ai& AiService::Handle::getAi() const {
+	return job_->ai_;
+}
+
+bool AiService::Handle::submit(const RawTetrisBoard& board, int depth) {
+	if (!job_ || active_ || !job_->done_) {
+		return false;
+	}
+	active_ = true;
+	job_->done_ = false;
+	job_->stop_ = false;
+	job_->bestDepth_ = 0;
+	if (board.isGameOver()) {
+		job_->state_ = Ai::State();
+		job_->done_ = true;
+		return true;
+	}
+	job_->board_ = board.getBitBoard();
+	job_->current_ = board.getBlock();
+	job_->next_ = board.getNextBlockType();
+	job_->rows_ = board.getRows();
+	job_->depth_ = depth;
+
+	// The pool outlives all its tasks, the destructor waits for them.
+	std::shared_ptr<Job> job = job_;
+	threadPool_->submit([job]() {
+		const int timeBudget = job->ai_.getTimeBudget();
+		const Ai::Clock::time_point deadline = timeBudget > 0
+			? Ai::Clock::now() + std::chrono::milliseconds(timeBudget) : Ai::Clock::time_point::max();
+		job->state_ = job->ai_.calculateBestState(job->board_, job->current_, job->next_, job->rows_, job->depth_,
+			job->threadPool_, job->workspace_, deadline, job->stop_, [&job](const Ai::State& state, int depth) {
+			std::lock_guard<std::mutex> lock(job->mutex_);
+			job->bestState_ = state;
+			job->bestDepth_ = depth;
+		});
+		job->done_ = true;
+	});
+	return true;
+}
+
+bool AiService::Handle::isActive() const {
+	return active_;
+}
+
+bool AiService::Handle::poll(Ai::State& state) {
+	if (!active_ || !job_->done_) {
+		return false;
+	}
+	state = job_->state_;
+	active_ = false;
+	return true;
+}
+
+bool AiService::Handle::interrupt(Ai::State& state) {
+	if (!active_) {
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(job_->mutex_);
+	if (job_->bestDepth_ == 0) {
+		return false;
+	}
+	state = job_->bestState_;
+	job_->stop_ = true;
+	active_ = false;
+	return true;
+}
+
+void AiService::Handle::cancel() {
+	if (active_) {
+		job_->stop_ = true;
+		active_ = false;
+	}
+}
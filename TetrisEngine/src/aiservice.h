@@ -0,0 +1,93 @@
+#ifndef AISERVICE_H
+#define AISERVICE_H
+
+#include "ai.h"
+#include "bitboard.h"
+#include "threadpool.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// A long lived service running the ai searches in a thread pool. Each ai player
+// gets a handle owning a copy of the ai and the preallocated memory used by the
+// workers. Searches are submitted and the results are polled without blocking.
+class AiService {
+public:
+	class Handle;
+
+	// Create the service with the number of worker threads.
+	explicit AiService(int workers);
+
+	// Return a handle for the ai, the ai is copied once.
+	Handle createHandle(const Ai& ai) const;
+
+private:
+	std::shared_ptr<ThreadPool> threadPool_;
+};
+
+class AiService::Handle {
+public:
+	Handle();
+
+	Handle(const Handle&) = delete;
+	Handle& operator=(const Handle&) = delete;
+
+	Handle(Handle&&) = default;
+	Handle& operator=(Handle&&) = default;
+
+	const Ai& getAi() const;
+
+	// Start a search for the current block on the board. Only the bit board, the
+	// blocks and the number of rows are copied. The search deepens iteratively, see
+	// Ai::calculateBestState. Return false if a search is still running (also a
+	// cancelled one), then nothing is done.
+	bool submit(const RawTetrisBoard& board, int depth);
+
+	// Return true if a search was submitted and is not yet polled, interrupted or cancelled.
+	bool isActive() const;
+
+	// Return true and set the state if the submitted search is done, never blocks.
+	bool poll(Ai::State& state);
+
+	// Return true and set the state to the best state of the deepest completed depth,
+	// the search is then stopped. Return false if no depth is completed yet, then
+	// the search continues. Never blocks.
+	bool interrupt(Ai::State& state);
+
+	// Stop the search and ignore its result.
+	void cancel();
+
+private:
+	friend class AiService;
+
+	// The data shared with the worker running the search.
+	struct Job {
+		Job(const Ai& ai, ThreadPool& threadPool);
+
+		ThreadPool& threadPool_;
+		Ai ai_;
+		Ai::Workspace workspace_;
+		BitBoard board_;
+		Block current_;
+		BlockType next_;
+		int rows_;
+		int depth_;
+		Ai::State state_;
+		std::atomic<bool> done_;
+		std::atomic<bool> stop_;
+
+		// The best state so far, updated each time a depth is completed.
+		std::mutex mutex_;
+		Ai::State bestState_;
+		int bestDepth_;
+	};
+
+	Handle(const Ai& ai, const std::shared_ptr<ThreadPool>& threadPool);
+
+	std::shared_ptr<ThreadPool> threadPool_;
+	std::shared_ptr<Job> job_;
+	bool active_;
+};
+
+#endif // AISERVICE_H
@@ -0,0 +1,348 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "block.h"
+#include "square.h"
+
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The occupancy of a tetris board, one bit per square and one machine word per row.
+// Bit i in a row is set when the square in column i is occupied. Rows are saved in
+// ascending order, i.e. row 0 is the bottom row. Rows above the saved rows are empty.
+//
+// The rows are stored inline with a fixed capacity, i.e. copying a bit board never
+// allocates memory. Only the saved rows are copied.
+//
+// The column heights, the number of squares in each column, the number of
+// transitions between occupied and empty squares and a hash of the content are
+// updated incrementally when squares are set and rows are removed.
+class BitBoard {
+public:
+	using Row = std::uint64_t;
+
+	static const int MAX_COLUMNS = 64;
+	static const int MAX_ROWS = 128;
+
+	BitBoard() : height_(0), columns_(0), filledRow_(0), rowTransitions_(0), columnTransitions_(0), hash_(0) {
+	}
+
+	BitBoard(int rows, int columns) {
+		clear(rows, columns);
+	}
+
+	BitBoard(const BitBoard& board) {
+		*this = board;
+	}
+
+	BitBoard& operator=(const BitBoard& board) {
+		height_ = board.height_;
+		columns_ = board.columns_;
+		filledRow_ = board.filledRow_;
+		rowTransitions_ = board.rowTransitions_;
+		columnTransitions_ = board.columnTransitions_;
+		hash_ = board.hash_;
+		std::copy(board.rows_.begin(), board.rows_.begin() + height_, rows_.begin());
+		std::copy(board.columnHeights_.begin(), board.columnHeights_.begin() + columns_, columnHeights_.begin());
+		std::copy(board.columnSquares_.begin(), board.columnSquares_.begin() + columns_, columnSquares_.begin());
+		return *this;
+	}
+
+	// Set all squares to empty and resize the board, the size is clamped to the
+	// limits.
+	void clear(int rows, int columns) {
+		height_ = std::max(0, std::min(rows, MAX_ROWS));
+		columns_ = std::max(0, std::min(columns, MAX_COLUMNS));
+		filledRow_ = columns_ >= MAX_COLUMNS ? ~Row(0) : (Row(1) << columns_) - 1;
+		std::fill(rows_.begin(), rows_.begin() + height_, Row(0));
+		std::fill(columnHeights_.begin(), columnHeights_.begin() + columns_, 0);
+		std::fill(columnSquares_.begin(), columnSquares_.begin() + columns_, 0);
+		rowTransitions_ = 0;
+		columnTransitions_ = 0;
+		hash_ = 0;
+	}
+
+	int getColumns() const {
+		return columns_;
+	}
+
+	// Return the number of saved rows.
+	int getHeight() const {
+		return height_;
+	}
+
+	// Return the bits for the row. Rows above the saved rows are empty.
+	Row getRow(int row) const {
+		return row < height_ ? rows_[row] : 0;
+	}
+
+	// Return a row with all squares occupied.
+	Row getFilledRow() const {
+		return filledRow_;
+	}
+
+	bool isRowFilled(int row) const {
+		return getRow(row) == filledRow_;
+	}
+
+	bool isRowEmpty(int row) const {
+		return getRow(row) == 0;
+	}
+
+	// Return true if the square is outside the board (except above) or occupied.
+	bool isOccupied(int row, int column) const {
+		if ((unsigned int) column >= (unsigned int) columns_ || row < 0) {
+			return true;
+		}
+		return (getRow(row) >> column) & 1;
+	}
+
+	// Return true if any square of the block is outside the board (except above) or occupied.
+	bool collision(const Block& block) const {
+		for (const Square& sq : block) {
+			if (isOccupied(sq.row_, sq.column_)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Return the number of rows up to and including the highest occupied square
+	// in the column. I.e. zero for an empty column.
+	int getColumnHeight(int column) const {
+		return columnHeights_[column];
+	}
+
+	// Return the number of rows up to and including the highest occupied square.
+	int getHighestColumnHeight() const {
+		return *std::max_element(columnHeights_.begin(), columnHeights_.begin() + columns_);
+	}
+
+	// Return the number of occupied squares in the column.
+	int getColumnSquares(int column) const {
+		return columnSquares_[column];
+	}
+
+	// Return the saved rows, getHeight() in total.
+	const Row* getRowData() const {
+		return rows_.data();
+	}
+
+	// Return the number of occupied squares for all columns, getColumns() in total.
+	const int* getColumnSquareData() const {
+		return columnSquares_.data();
+	}
+
+	// Return the number of horizontally adjacent squares inside the board where
+	// one square is occupied and the other is empty, summed over all rows.
+	int getRowTransitions() const {
+		return rowTransitions_;
+	}
+
+	// Return the number of vertically adjacent squares where one square is occupied
+	// and the other is empty, summed over all columns. The square below row 0 is not
+	// counted, the squares above the saved rows are empty.
+	int getColumnTransitions() const {
+		return columnTransitions_;
+	}
+
+	// Return a Zobrist style hash of the occupied squares, each nonempty row adds
+	// a key from its index and content. Boards with the same occupied squares have
+	// the same hash, independent of the number of saved empty rows.
+	std::uint64_t getHash() const {
+		return hash_;
+	}
+
+	// Return the number of steps the block can move down before colliding.
+	// The block must not collide in its current position.
+	int getDropDistance(const Block& block) const {
+		if (block.getBlockType() == BlockType::EMPTY || block.getBlockType() == BlockType::WALL) {
+			return getDropDistanceByCollision(block);
+		}
+		const BlockShape& shape = block.getShape();
+		const int leftColumn = block.getStartColumn() + shape.leftColumn_;
+		int distance = MAX_ROWS;
+		for (int i = 0; i < shape.width_; ++i) {
+			int bottom = block.getLowestStartRow() + shape.bottom_[i];
+			int height = getColumnHeight(leftColumn + i);
+			if (height > bottom) {
+				// Occupied square above the block, the block is below an overhang.
+				return getDropDistanceByCollision(block);
+			}
+			distance = std::min(distance, bottom - height);
+		}
+		return distance;
+	}
+
+	// Occupy the square. The square must be inside the saved rows and the columns.
+	void set(int row, int column) {
+		const Row bit = Row(1) << column;
+		if (rows_[row] & bit) {
+			return;
+		}
+		rowTransitions_ -= calculateRowTransitions(rows_[row]);
+		hash_ ^= hashRow(row, rows_[row]);
+		rows_[row] |= bit;
+		rowTransitions_ += calculateRowTransitions(rows_[row]);
+		hash_ ^= hashRow(row, rows_[row]);
+		if (row > 0) {
+			columnTransitions_ += (rows_[row - 1] & bit) ? -1 : 1;
+		}
+		columnTransitions_ += (getRow(row + 1) & bit) ? -1 : 1;
+		++columnSquares_[column];
+		columnHeights_[column] = std::max(columnHeights_[column], row + 1);
+	}
+
+	// Remove the row, all rows above are moved one step down.
+	void eraseRow(int row) {
+		const Row removed = rows_[row];
+		const Row below = row > 0 ? rows_[row - 1] : 0;
+		const Row above = getRow(row + 1);
+		rowTransitions_ -= calculateRowTransitions(removed);
+		columnTransitions_ -= bitCount(removed ^ above);
+		if (row > 0) {
+			columnTransitions_ += bitCount(below ^ above) - bitCount(below ^ removed);
+		}
+
+		// All rows above change index.
+		const int highestRow = getHighestColumnHeight();
+		for (int i = row; i < highestRow; ++i) {
+			hash_ ^= hashRow(i, rows_[i]);
+		}
+		std::copy(rows_.begin() + row + 1, rows_.begin() + height_, rows_.begin() + row);
+		--height_;
+		for (int i = row; i < highestRow - 1; ++i) {
+			hash_ ^= hashRow(i, rows_[i]);
+		}
+
+		for (int column = 0; column < columns_; ++column) {
+			const Row bit = Row(1) << column;
+			if (removed & bit) {
+				--columnSquares_[column];
+			}
+			if (columnHeights_[column] > row + 1) {
+				--columnHeights_[column];
+			} else if (columnHeights_[column] == row + 1) {
+				// The highest square was removed, find the next below.
+				int height = row;
+				while (height > 0 && (rows_[height - 1] & bit) == 0) {
+					--height;
+				}
+				columnHeights_[column] = height;
+			}
+		}
+	}
+
+	// Remove the row, all rows above are moved one step down. An empty row is
+	// added at the top if the number of saved rows becomes less than minHeight.
+	void removeRow(int row, int minHeight) {
+		eraseRow(row);
+		if (height_ < minHeight) {
+			pushEmptyRow();
+		}
+	}
+
+	// Add the rows at the bottom, all rows are moved up. The top rows
+	// exceeding MAX_ROWS are discarded.
+	void insertBottomRows(const std::vector<Row>& rows) {
+		int size = std::min((int) rows.size(), MAX_ROWS);
+		int kept = std::min(height_, MAX_ROWS - size);
+		std::copy_backward(rows_.begin(), rows_.begin() + kept, rows_.begin() + kept + size);
+		std::copy(rows.begin(), rows.begin() + size, rows_.begin());
+		height_ = kept + size;
+		recount();
+	}
+
+	// Add an empty row at the top.
+	void pushEmptyRow() {
+		if (height_ < MAX_ROWS) {
+			rows_[height_++] = 0;
+		}
+	}
+
+	// Convert a row of block types to bits.
+	template <class Iterator>
+	static Row toRow(Iterator begin, Iterator end) {
+		Row row = 0;
+		int column = 0;
+		for (auto it = begin; it != end; ++it, ++column) {
+			if (*it != BlockType::EMPTY) {
+				row |= Row(1) << column;
+			}
+		}
+		return row;
+	}
+
+	// Return a well mixed hash of the value, the splitmix64 finalizer.
+	static std::uint64_t mixHash(std::uint64_t value) {
+		value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+		return value ^ (value >> 31);
+	}
+
+	// Return the number of set bits.
+	static int bitCount(Row row) {
+#ifdef _MSC_VER
+		return (int) __popcnt64(row);
+#else
+		return __builtin_popcountll(row);
+#endif
+	}
+
+private:
+	static std::uint64_t hashRow(int row, Row bits) {
+		return bits == 0 ? 0 : mixHash(bits ^ mixHash(row + 1));
+	}
+
+	int calculateRowTransitions(Row row) const {
+		return bitCount((row ^ (row >> 1)) & (filledRow_ >> 1));
+	}
+
+	// Calculate all incrementally updated values from the rows.
+	void recount() {
+		std::fill(columnHeights_.begin(), columnHeights_.begin() + columns_, 0);
+		std::fill(columnSquares_.begin(), columnSquares_.begin() + columns_, 0);
+		rowTransitions_ = 0;
+		columnTransitions_ = 0;
+		hash_ = 0;
+		for (int row = 0; row < height_; ++row) {
+			rowTransitions_ += calculateRowTransitions(rows_[row]);
+			hash_ ^= hashRow(row, rows_[row]);
+			columnTransitions_ += bitCount(rows_[row] ^ getRow(row + 1));
+			for (int column = 0; column < columns_; ++column) {
+				if ((rows_[row] >> column) & 1) {
+					++columnSquares_[column];
+					columnHeights_[column] = row + 1;
+				}
+			}
+		}
+	}
+
+	int getDropDistanceByCollision(Block block) const {
+		int distance = 0;
+		block.moveDown();
+		while (!collision(block)) {
+			++distance;
+			block.moveDown();
+		}
+		return distance;
+	}
+
+	std::array<Row, MAX_ROWS> rows_;
+	std::array<int, MAX_COLUMNS> columnHeights_;
+	std::array<int, MAX_COLUMNS> columnSquares_;
+	int height_;
+	int columns_;
+	Row filledRow_;
+	int rowTransitions_;
+	int columnTransitions_;
+	std::uint64_t hash_;
+};
+
+#endif // BITBOARD_H
@@ -2,6 +2,131 @@
 
 #include <algorithm>
 
+namespace {
+
+	const int NBR_OF_BLOCK_TYPES = 7;
+
+	// The squares in the start rotation of a block type.
+	struct StartShape {
+		SquareOffset squares_[4];
+		int rotationSquareIndex_;
+		int maxRotations_;	// The value returned by Block::getNumberOfRotations().
+		int orientations_;	// The number of different rotations.
+	};
+
+	// Same order as BlockType.
+	constexpr StartShape START_SHAPES[NBR_OF_BLOCK_TYPES] = {
+		{{{3, 0}, {2, 0}, {1, 0}, {0, 0}}, 2, 1, 2},	// I
+		{{{2, 1}, {1, 1}, {0, 1}, {0, 0}}, 1, 4, 4},	// J
+		{{{2, 0}, {1, 0}, {0, 0}, {0, 1}}, 1, 4, 4},	// L
+		{{{1, 0}, {1, 1}, {0, 0}, {0, 1}}, 0, 0, 1},	// O
+		{{{1, 1}, {1, 0}, {0, 0}, {0, -1}}, 2, 1, 2},	// S
+		{{{1, 0}, {0, 1}, {0, 0}, {0, -1}}, 2, 4, 4},	// T
+		{{{1, -1}, {1, 0}, {0, 0}, {0, 1}}, 2, 1, 2}	// Z
+	};
+
+	struct BlockShapes {
+		BlockShape shapes_[NBR_OF_BLOCK_TYPES][4];
+	};
+
+	constexpr BlockShape createShape(const SquareOffset (&squares)[4]) {
+		BlockShape shape{};
+		int leftColumn = squares[0].column_;
+		int rightColumn = squares[0].column_;
+		int lowestRow = squares[0].row_;
+		for (int i = 0; i < 4; ++i) {
+			shape.squares_[i] = squares[i];
+			leftColumn = std::min(leftColumn, squares[i].column_);
+			rightColumn = std::max(rightColumn, squares[i].column_);
+			lowestRow = std::min(lowestRow, squares[i].row_);
+		}
+		shape.leftColumn_ = leftColumn;
+		shape.width_ = rightColumn - leftColumn + 1;
+		shape.lowestRow_ = lowestRow;
+		for (int column = 0; column < shape.width_; ++column) {
+			int bottom = 4;
+			for (int i = 0; i < 4; ++i) {
+				if (squares[i].column_ == leftColumn + column) {
+					bottom = std::min(bottom, squares[i].row_);
+				}
+			}
+			shape.bottom_[column] = bottom;
+		}
+		return shape;
+	}
+
+	// Rotate all squares 90 degrees counterclockwise around the rotation square.
+	constexpr BlockShape rotateLeft(const BlockShape& shape, int rotationSquareIndex) {
+		const SquareOffset center = shape.squares_[rotationSquareIndex];
+		SquareOffset squares[4]{};
+		for (int i = 0; i < 4; ++i) {
+			squares[i].column_ = center.column_ + center.row_ - shape.squares_[i].row_;
+			squares[i].row_ = shape.squares_[i].column_ + center.row_ - center.column_;
+		}
+		return createShape(squares);
+	}
+
+	constexpr BlockShapes createBlockShapes() {
+		BlockShapes blockShapes{};
+		for (int type = 0; type < NBR_OF_BLOCK_TYPES; ++type) {
+			const StartShape& start = START_SHAPES[type];
+			blockShapes.shapes_[type][0] = createShape(start.squares_);
+			for (int rotation = 1; rotation < start.orientations_; ++rotation) {
+				blockShapes.shapes_[type][rotation] = rotateLeft(blockShapes.shapes_[type][rotation - 1], start.rotationSquareIndex_);
+			}
+		}
+		return blockShapes;
+	}
+
+	constexpr BlockShapes BLOCK_SHAPES = createBlockShapes();
+
+	constexpr bool equal(const BlockShape& shape1, const BlockShape& shape2) {
+		for (int i = 0; i < 4; ++i) {
+			if (shape1.squares_[i].row_ != shape2.squares_[i].row_ || shape1.squares_[i].column_ != shape2.squares_[i].column_) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// One more rotation from the last rotation must give back the start rotation.
+	constexpr bool isRotationCyclic() {
+		for (int type = 0; type < NBR_OF_BLOCK_TYPES; ++type) {
+			const StartShape& start = START_SHAPES[type];
+			if (start.orientations_ == 4) {
+				const BlockShape& last = BLOCK_SHAPES.shapes_[type][3];
+				if (!equal(rotateLeft(last, start.rotationSquareIndex_), BLOCK_SHAPES.shapes_[type][0])) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	static_assert(isRotationCyclic(), "Four rotations must give back the start rotation");
+	static_assert(BLOCK_SHAPES.shapes_[(int) BlockType::I][1].width_ == 4, "I block must be horizontal after one rotation");
+	static_assert(BLOCK_SHAPES.shapes_[(int) BlockType::O][0].width_ == 2, "O block must be two squares wide");
+
+} // Anonymous namespace.
+
+const BlockShape& Block::getShape(BlockType blockType, int rotation) {
+	return BLOCK_SHAPES.shapes_[(int) blockType][rotation];
+}
+
+int Block::getNumberOfRotations(BlockType blockType) {
+	if (blockType == BlockType::EMPTY || blockType == BlockType::WALL) {
+		return 0;
+	}
+	return START_SHAPES[(int) blockType].maxRotations_;
+}
+
+int Block::getNumberOfOrientations(BlockType blockType) {
+	if (blockType == BlockType::EMPTY || blockType == BlockType::WALL) {
+		return 1;
+	}
+	return START_SHAPES[(int) blockType].orientations_;
+}
+
 Block::Block() : maxRotations_(0), currentRotation_(0), rotationSquareIndex_(0),
 blockType_(BlockType::EMPTY), lowestStartRow_(0), startColumn_(0) {
 	squares_[0] = Square(blockType_, 0, 0);
@@ -12,78 +137,28 @@ blockType_(BlockType::EMPTY), lowestStartRow_(0), startColumn_(0) {
 
 Block::Block(BlockType blockType, int lowestStartRow, int leftColumn, int currentRotation)
 	: Block(blockType, lowestStartRow, leftColumn) {
-	
-	for (int i = 0; i < currentRotation; ++i) {
-		rotateLeft();
+
+	if (maxRotations_ > 0 && currentRotation > 0) {
+		currentRotation_ = currentRotation % getNumberOfOrientations(blockType);
+		updateSquares();
 	}
 }
 
-Block::Block(BlockType blockType, int lowestStartRow, int startColumn) : maxRotations_(4),
+Block::Block(BlockType blockType, int lowestStartRow, int startColumn) : maxRotations_(0),
 currentRotation_(0), rotationSquareIndex_(0), blockType_(blockType), startColumn_(startColumn),
 lowestStartRow_(lowestStartRow) {
 
-	int nbrOfSquares = 0;
-    switch (blockType) {
-	case BlockType::EMPTY:
-		maxRotations_ = 0;
-		squares_[nbrOfSquares++] = Square(blockType_, 0, 0);
-		squares_[nbrOfSquares++] = Square(blockType_, 0, 0);
-		squares_[nbrOfSquares++] = Square(blockType_, 0, 0);
-		squares_[nbrOfSquares++] = Square(blockType_, 0, 0);
-		break;
-	case BlockType::I:
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 3, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 2, startColumn);
-		rotationSquareIndex_ = nbrOfSquares;
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn);
-		maxRotations_ = 1;
-		break;
-	case BlockType::J:
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 2, startColumn + 1);
-		rotationSquareIndex_ = nbrOfSquares;
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn + 1);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn + 1);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn);
-		break;
-	case BlockType::L:
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 2, startColumn);
-		rotationSquareIndex_ = nbrOfSquares;
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn + 1);
-		break;
-	case BlockType::O:
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn + 1);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn + 1);
-		maxRotations_ = 0;
-		break;
-	case BlockType::S:
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn + 1);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn);
-		rotationSquareIndex_ = nbrOfSquares;
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn - 1);
-		maxRotations_ = 1;
-		break;
-	case BlockType::T:
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn + 1);
-		rotationSquareIndex_ = nbrOfSquares;
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn - 1);
-		break;
-	case BlockType::Z:
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn - 1);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_ + 1, startColumn);
-		rotationSquareIndex_ = nbrOfSquares;
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn);
-		squares_[nbrOfSquares++] = Square(blockType_, lowestStartRow_, startColumn + 1);
-		maxRotations_ = 1;
-		break;
-    }
+	if (blockType == BlockType::EMPTY || blockType == BlockType::WALL) {
+		squares_[0] = Square(blockType_, 0, 0);
+		squares_[1] = Square(blockType_, 0, 0);
+		squares_[2] = Square(blockType_, 0, 0);
+		squares_[3] = Square(blockType_, 0, 0);
+	} else {
+		const StartShape& start = START_SHAPES[(int) blockType];
+		maxRotations_ = start.maxRotations_;
+		rotationSquareIndex_ = start.rotationSquareIndex_;
+		updateSquares();
+	}
 }
 
 void Block::moveLeft() {
@@ -115,34 +190,23 @@ void Block::moveDown() {
 }
 
 void Block::rotateLeft() {
-	int row = squares_[rotationSquareIndex_].row_;
-	int column = squares_[rotationSquareIndex_].column_;
-	currentRotation_ = (currentRotation_ + 1) % 4;
-
-	// Rotate back to start orientation?
-	if (currentRotation_ > maxRotations_) {
-		currentRotation_ = 0;
-		for (int i = 0; i < maxRotations_; ++i) {
-			rotateRight();
-		}
-	} else {
-		// Rotate to the right!
-		for (Square& sq : squares_) {
-			Square tmp = sq;
-			tmp.column_ = column + row - sq.row_;
-			tmp.row_ = sq.column_ + row - column;
-			sq = tmp;
-		}
+	if (maxRotations_ > 0) {
+		currentRotation_ = (currentRotation_ + 1) % getNumberOfOrientations(blockType_);
+		updateSquares();
 	}
 }
 
 void Block::rotateRight() {
-	int row = squares_[rotationSquareIndex_].row_;
-	int column = squares_[rotationSquareIndex_].column_;
-	for (Square& sq : squares_) {
-		Square tmp = sq;
-		tmp.column_ = sq.row_ + column - row;
-		tmp.row_ = column + row - sq.column_;
-		sq = tmp;
+	if (maxRotations_ > 0) {
+		int orientations = getNumberOfOrientations(blockType_);
+		currentRotation_ = (currentRotation_ + orientations - 1) % orientations;
+		updateSquares();
+	}
+}
+
+void Block::updateSquares() {
+	const BlockShape& shape = getShape();
+	for (int i = 0; i < 4; ++i) {
+		squares_[i] = Square(blockType_, lowestStartRow_ + shape.squares_[i].row_, startColumn_ + shape.squares_[i].column_);
 	}
 }
@@ -6,6 +6,21 @@
 #include <array>
 #include <algorithm>
 
+// The position of a square relative to the start position of a block,
+// i.e. relative to the lowest start row and the start column.
+struct SquareOffset {
+	int row_, column_;
+};
+
+// The squares of a block type in one rotation.
+struct BlockShape {
+	SquareOffset squares_[4];
+	int leftColumn_;	// The leftmost column offset.
+	int width_;			// The number of columns used.
+	int lowestRow_;		// The lowest row offset.
+	int bottom_[4];		// The lowest row offset in each column, from the leftmost column.
+};
+
 class Block {
 public:
 	using const_iterator = std::array<Square, 4>::const_iterator;
@@ -68,7 +83,26 @@ public:
 		return startColumn_;
 	}
 
+	// Return the shape for the current rotation.
+	const BlockShape& getShape() const {
+		return getShape(blockType_, currentRotation_);
+	}
+
+	// Return the shape for the block type and rotation. The rotation must be less than
+	// getNumberOfOrientations() for the block type and the block type must not be
+	// BlockType::EMPTY or BlockType::WALL.
+	static const BlockShape& getShape(BlockType blockType, int rotation);
+
+	// Return the number of rotations for the block type, the same as getNumberOfRotations().
+	static int getNumberOfRotations(BlockType blockType);
+
+	// Return the number of different rotations for the block type, i.e. 1, 2 or 4.
+	static int getNumberOfOrientations(BlockType blockType);
+
 private:
+	// Place the squares according to the shape for the current rotation.
+	void updateSquares();
+
 	int rotationSquareIndex_;
 	std::array<Square, 4> squares_;
 	int maxRotations_, currentRotation_;
@@ -0,0 +1,82 @@
+#include "blockgenerator.h"
+
+#include <random>
+#include <utility>
+
+namespace {
+
+	// The splitmix64 generator, spreads nearby seeds over the whole state.
+	std::uint64_t splitMix(std::uint64_t& value) {
+		std::uint64_t z = (value += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+	const std::array<BlockType, 7> BLOCK_TYPES = {
+		BlockType::I, BlockType::J, BlockType::L, BlockType::O, BlockType::S, BlockType::T, BlockType::Z
+	};
+
+} // Anonymous namespace.
+
+BlockGenerator::BlockGenerator() : BlockGenerator(createSeed()) {
+}
+
+BlockGenerator::BlockGenerator(std::uint64_t seed, Mode mode) : mode_(mode) {
+	reset(seed);
+}
+
+void BlockGenerator::reset(std::uint64_t seed) {
+	seed_ = seed;
+	std::uint64_t value = seed;
+	state_ = splitMix(value);
+	// Must be odd.
+	increment_ = splitMix(value) | 1;
+	bag_ = BLOCK_TYPES;
+	bagIndex_ = (int) bag_.size();
+}
+
+BlockType BlockGenerator::generateBlockType() {
+	if (mode_ == Mode::BAG) {
+		if (bagIndex_ >= (int) bag_.size()) {
+			// Fisher-Yates shuffle of a new bag.
+			bag_ = BLOCK_TYPES;
+			for (int i = (int) bag_.size() - 1; i > 0; --i) {
+				std::swap(bag_[i], bag_[generateInt(0, i)]);
+			}
+			bagIndex_ = 0;
+		}
+		return bag_[bagIndex_++];
+	}
+	return BLOCK_TYPES[generateInt(0, (int) BLOCK_TYPES.size() - 1)];
+}
+
+int BlockGenerator::generateInt(int min, int max) {
+	const std::uint32_t bound = (std::uint32_t) (max - min) + 1;
+	// Reject the lowest values making the modulo biased.
+	const std::uint32_t threshold = (0u - bound) % bound;
+	while (true) {
+		std::uint32_t value = generate();
+		if (value >= threshold) {
+			return min + (int) (value % bound);
+		}
+	}
+}
+
+std::uint64_t BlockGenerator::createSeed() {
+	std::random_device device;
+	return ((std::uint64_t) device() << 32) ^ device();
+}
+
+std::uint64_t BlockGenerator::nextSeed(std::uint64_t seed) {
+	return splitMix(seed);
+}
+
+std::uint32_t BlockGenerator::generate() {
+	// PCG-XSH-RR.
+	const std::uint64_t state = state_;
+	state_ = state * 6364136223846793005ULL + increment_;
+	const std::uint32_t xorShifted = (std::uint32_t) (((state >> 18) ^ state) >> 27);
+	const std::uint32_t rotation = (std::uint32_t) (state >> 59);
+	return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31));
+}
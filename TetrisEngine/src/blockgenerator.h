@@ -0,0 +1,57 @@
+#ifndef BLOCKGENERATOR_H
+#define BLOCKGENERATOR_H
+
+#include "square.h"
+
+#include <array>
+#include <cstdint>
+
+// Generates the block types for one game with the PCG32 random generator, i.e.
+// cheap to create and to copy. The same seed and mode always give the same
+// sequence, so a game can be reproduced from its seed.
+class BlockGenerator {
+public:
+	enum class Mode {
+		UNIFORM,	// Each block type is drawn independently.
+		BAG			// All seven block types in random order, then a new bag.
+	};
+
+	// Seeded from the operating system.
+	BlockGenerator();
+
+	explicit BlockGenerator(std::uint64_t seed, Mode mode = Mode::UNIFORM);
+
+	// Restart the sequence from the seed, the mode is kept.
+	void reset(std::uint64_t seed);
+
+	BlockType generateBlockType();
+
+	// Return a number in [min, max], without bias.
+	int generateInt(int min, int max);
+
+	std::uint64_t getSeed() const {
+		return seed_;
+	}
+
+	Mode getMode() const {
+		return mode_;
+	}
+
+	// Return a new seed from the operating system.
+	static std::uint64_t createSeed();
+
+	// Return the seed following the seed, to derive a sequence of seeds from one seed.
+	static std::uint64_t nextSeed(std::uint64_t seed);
+
+private:
+	std::uint32_t generate();
+
+	std::uint64_t state_;
+	std::uint64_t increment_;
+	std::uint64_t seed_;
+	Mode mode_;
+	std::array<BlockType, 7> bag_;
+	int bagIndex_;
+};
+
+#endif // BLOCKGENERATOR_H
@@ -0,0 +1,250 @@
+#include "boardcorpus.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+	const char MAGIC[8] = {'T', 'C', 'O', 'R', 'P', 'U', 'S', '1'};
+
+	int getStoredRows(int rows) {
+		return rows + 4;
+	}
+
+	int getBytesPerRow(int columns) {
+		return (columns + 7) / 8;
+	}
+
+	void writeLittleEndian(unsigned char* data, std::uint64_t value, int bytes) {
+		for (int i = 0; i < bytes; ++i) {
+			data[i] = (unsigned char) (value >> (8 * i));
+		}
+	}
+
+	std::uint64_t readLittleEndian(const unsigned char* data, int bytes) {
+		std::uint64_t value = 0;
+		for (int i = bytes - 1; i >= 0; --i) {
+			value = value << 8 | data[i];
+		}
+		return value;
+	}
+
+	void createHeader(unsigned char* header, int rows, int columns) {
+		std::memcpy(header, MAGIC, sizeof(MAGIC));
+		writeLittleEndian(header + 8, rows, 2);
+		writeLittleEndian(header + 10, columns, 2);
+		writeLittleEndian(header + 12, BoardCorpus::getRecordSize(rows, columns), 4);
+	}
+
+	// Return false if the header is not a valid corpus header.
+	bool readHeader(const unsigned char* header, int& rows, int& columns, int& recordSize) {
+		rows = (int) readLittleEndian(header + 8, 2);
+		columns = (int) readLittleEndian(header + 10, 2);
+		recordSize = (int) readLittleEndian(header + 12, 4);
+		return std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0
+			&& columns > 0 && columns <= BitBoard::MAX_COLUMNS
+			&& rows > 0 && getStoredRows(rows) <= BitBoard::MAX_ROWS
+			&& recordSize == BoardCorpus::getRecordSize(rows, columns);
+	}
+
+} // Anonymous namespace.
+
+int BoardCorpus::getRecordSize(int rows, int columns) {
+	const int size = 8 + getStoredRows(rows) * getBytesPerRow(columns);
+	return (size + 7) / 8 * 8;
+}
+
+BoardCorpusWriter::BoardCorpusWriter() : file_(nullptr), rows_(0), columns_(0) {
+}
+
+BoardCorpusWriter::~BoardCorpusWriter() {
+	close();
+}
+
+bool BoardCorpusWriter::open(const std::string& file, int rows, int columns) {
+	close();
+	if (columns <= 0 || columns > BitBoard::MAX_COLUMNS || rows <= 0 || getStoredRows(rows) > BitBoard::MAX_ROWS) {
+		return false;
+	}
+	unsigned char header[BoardCorpus::HEADER_SIZE];
+	createHeader(header, rows, columns);
+
+	// Append if the existing file has the same header.
+	if (std::FILE* existing = std::fopen(file.c_str(), "rb")) {
+		unsigned char existingHeader[BoardCorpus::HEADER_SIZE];
+		const bool same = std::fread(existingHeader, 1, sizeof(existingHeader), existing) == sizeof(existingHeader)
+			&& std::memcmp(header, existingHeader, sizeof(header)) == 0;
+		std::fclose(existing);
+		if (same) {
+			file_ = std::fopen(file.c_str(), "ab");
+		}
+	}
+	if (file_ == nullptr) {
+		file_ = std::fopen(file.c_str(), "wb");
+		if (file_ != nullptr && std::fwrite(header, 1, sizeof(header), file_) != sizeof(header)) {
+			close();
+		}
+	}
+	if (file_ == nullptr) {
+		return false;
+	}
+	rows_ = rows;
+	columns_ = columns;
+	record_.assign(BoardCorpus::getRecordSize(rows, columns), '\0');
+	return true;
+}
+
+void BoardCorpusWriter::close() {
+	if (file_ != nullptr) {
+		std::fclose(file_);
+		file_ = nullptr;
+	}
+}
+
+bool BoardCorpusWriter::write(const RawTetrisBoard& board) {
+	return board.getRows() == rows_ && write(board.getBitBoard(), board.getBlock(), board.getNextBlockType());
+}
+
+bool BoardCorpusWriter::write(const BitBoard& board, const Block& current, BlockType next) {
+	if (file_ == nullptr || board.getColumns() != columns_) {
+		return false;
+	}
+	unsigned char* record = (unsigned char*) &record_[0];
+	std::fill(record_.begin(), record_.end(), '\0');
+	record[0] = (unsigned char) current.getBlockType();
+	record[1] = (unsigned char) current.getCurrentRotation();
+	record[2] = (unsigned char) next;
+	writeLittleEndian(record + 4, (std::uint16_t) current.getLowestStartRow(), 2);
+	writeLittleEndian(record + 6, (std::uint16_t) current.getStartColumn(), 2);
+	const int bytesPerRow = getBytesPerRow(columns_);
+	for (int row = 0; row < getStoredRows(rows_); ++row) {
+		writeLittleEndian(record + 8 + row * bytesPerRow, board.getRow(row), bytesPerRow);
+	}
+	return std::fwrite(record, 1, record_.size(), file_) == record_.size();
+}
+
+BoardCorpusReader::BoardCorpusReader() : data_(nullptr), fileSize_(0), size_(0), rows_(0), columns_(0), recordSize_(0)
+#ifdef _WIN32
+	, file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#endif
+{
+}
+
+BoardCorpusReader::~BoardCorpusReader() {
+	close();
+}
+
+bool BoardCorpusReader::open(const std::string& file) {
+	close();
+#ifdef _WIN32
+	file_ = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER size;
+	if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size) || size.QuadPart < BoardCorpus::HEADER_SIZE) {
+		close();
+		return false;
+	}
+	mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_ == nullptr) {
+		close();
+		return false;
+	}
+	data_ = (const unsigned char*) MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	fileSize_ = (std::size_t) size.QuadPart;
+#else
+	int descriptor = ::open(file.c_str(), O_RDONLY);
+	struct stat status;
+	if (descriptor < 0 || fstat(descriptor, &status) != 0 || status.st_size < BoardCorpus::HEADER_SIZE) {
+		if (descriptor >= 0) {
+			::close(descriptor);
+		}
+		return false;
+	}
+	void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	// The mapping is kept after the file is closed.
+	::close(descriptor);
+	if (data != MAP_FAILED) {
+		data_ = (const unsigned char*) data;
+		fileSize_ = (std::size_t) status.st_size;
+	}
+#endif
+	if (data_ == nullptr || !readHeader(data_, rows_, columns_, recordSize_)) {
+		close();
+		return false;
+	}
+	// A partly written last record is ignored.
+	size_ = (fileSize_ - BoardCorpus::HEADER_SIZE) / recordSize_;
+	return true;
+}
+
+void BoardCorpusReader::close() {
+#ifdef _WIN32
+	if (data_ != nullptr) {
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_ != nullptr) {
+		CloseHandle(mapping_);
+		mapping_ = nullptr;
+	}
+	if (file_ != INVALID_HANDLE_VALUE) {
+		CloseHandle(file_);
+		file_ = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (data_ != nullptr) {
+		munmap((void*) data_, fileSize_);
+	}
+#endif
+	data_ = nullptr;
+	fileSize_ = 0;
+	size_ = 0;
+}
+
+BoardCorpus::Position BoardCorpusReader::read(std::size_t index) const {
+	const unsigned char* record = data_ + BoardCorpus::HEADER_SIZE + index * recordSize_;
+	const int lowestStartRow = (std::int16_t) readLittleEndian(record + 4, 2);
+	const int startColumn = (std::int16_t) readLittleEndian(record + 6, 2);
+	BoardCorpus::Position position{BitBoard(), Block((BlockType) record[0], lowestStartRow, startColumn, record[1]),
+		(BlockType) record[2]};
+
+	// Same height as the board in the game, i.e. at least the number of rows.
+	const int bytesPerRow = getBytesPerRow(columns_);
+	std::vector<BitBoard::Row> bits(getStoredRows(rows_));
+	int height = rows_;
+	for (int row = 0; row < (int) bits.size(); ++row) {
+		bits[row] = readLittleEndian(record + 8 + row * bytesPerRow, bytesPerRow);
+		if (bits[row] != 0) {
+			height = std::max(height, row + 1);
+		}
+	}
+	bits.resize(height);
+	position.board_.clear(0, columns_);
+	position.board_.insertBottomRows(bits);
+	return position;
+}
+
+RawTetrisBoard BoardCorpusReader::createBoard(std::size_t index) const {
+	const BoardCorpus::Position position = read(index);
+	const int height = position.board_.getHeight();
+	std::vector<BlockType> squares(height * columns_, BlockType::EMPTY);
+	for (int row = 0; row < height; ++row) {
+		for (int column = 0; column < columns_; ++column) {
+			if (position.board_.isOccupied(row, column)) {
+				squares[row * columns_ + column] = BlockType::WALL;
+			}
+		}
+	}
+	return RawTetrisBoard(squares, rows_, columns_, position.current_, position.next_);
+}
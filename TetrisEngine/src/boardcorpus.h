@@ -0,0 +1,120 @@
+#ifndef BOARDCORPUS_H
+#define BOARDCORPUS_H
+
+#include "bitboard.h"
+#include "block.h"
+#include "rawtetrisboard.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// A file with board positions, i.e. the occupied squares, the current block and
+// the next block. All positions in a file have the same board size and are saved
+// as records of the same size after a header, i.e. the position with index i is
+// found directly at a known offset and the file can be memory mapped and read
+// without parsing. Rows above rows + 4 and the block types of the squares are
+// not saved.
+//
+// Header, 16 bytes: "TCORPUS1", rows (uint16), columns (uint16), record size (uint32).
+// Record: current block type, rotation and next block type (uint8 each), one
+// unused byte, lowest start row and start column (int16 each) and then the rows
+// from the bottom, (columns + 7) / 8 bytes each. All values little endian, the
+// record is padded to a multiple of 8 bytes.
+class BoardCorpus {
+public:
+	struct Position {
+		BitBoard board_;
+		Block current_;
+		BlockType next_;
+	};
+
+	static const int HEADER_SIZE = 16;
+
+	// Return the size in bytes of each record.
+	static int getRecordSize(int rows, int columns);
+};
+
+// Appends positions to a corpus file.
+class BoardCorpusWriter {
+public:
+	BoardCorpusWriter();
+	~BoardCorpusWriter();
+
+	BoardCorpusWriter(const BoardCorpusWriter&) = delete;
+	BoardCorpusWriter& operator=(const BoardCorpusWriter&) = delete;
+
+	// Open the file for the board size. An existing file with the same board size
+	// is appended to, else a new file is created. Return false on failure.
+	bool open(const std::string& file, int rows, int columns);
+
+	void close();
+
+	bool isOpen() const {
+		return file_ != nullptr;
+	}
+
+	// Save the position, boards of another size are ignored. Return false if not saved.
+	bool write(const RawTetrisBoard& board);
+
+	bool write(const BitBoard& board, const Block& current, BlockType next);
+
+private:
+	std::FILE* file_;
+	int rows_;
+	int columns_;
+	std::string record_;
+};
+
+// Reads positions from a memory mapped corpus file.
+class BoardCorpusReader {
+public:
+	BoardCorpusReader();
+	~BoardCorpusReader();
+
+	BoardCorpusReader(const BoardCorpusReader&) = delete;
+	BoardCorpusReader& operator=(const BoardCorpusReader&) = delete;
+
+	// Return false if the file is missing or not a corpus file.
+	bool open(const std::string& file);
+
+	void close();
+
+	bool isOpen() const {
+		return data_ != nullptr;
+	}
+
+	int getRows() const {
+		return rows_;
+	}
+
+	int getColumns() const {
+		return columns_;
+	}
+
+	// Return the number of positions.
+	std::size_t getSize() const {
+		return size_;
+	}
+
+	// Return the position with the index, index < getSize().
+	BoardCorpus::Position read(std::size_t index) const;
+
+	// Return a board with the position, occupied squares get the block type BlockType::WALL.
+	RawTetrisBoard createBoard(std::size_t index) const;
+
+private:
+	const unsigned char* data_;
+	std::size_t fileSize_;
+	std::size_t size_;
+	int rows_;
+	int columns_;
+	int recordSize_;
+#ifdef _WIN32
+	void* file_;
+	void* mapping_;
+#endif
+};
+
+#endif // BOARDCORPUS_H
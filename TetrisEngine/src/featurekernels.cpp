@@ -0,0 +1,116 @@
+#include "featurekernels.h"
+#include "bitboard.h"
+
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FEATUREKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+#ifdef FEATUREKERNELS_SSE2
+	int weightedBitCountSse2(const std::uint64_t* rows, int size, std::uint64_t mask) {
+		const __m128i masks = _mm_set1_epi64x((long long) mask);
+		const __m128i m1 = _mm_set1_epi8(0x55);
+		const __m128i m2 = _mm_set1_epi8(0x33);
+		const __m128i m4 = _mm_set1_epi8(0x0f);
+		const __m128i zero = _mm_setzero_si128();
+		__m128i weights = _mm_set_epi64x(1, 0);
+		const __m128i step = _mm_set1_epi64x(2);
+		__m128i sum = zero;
+
+		// Two rows at a time, one in each 64 bit lane.
+		int row = 0;
+		for (; row + 1 < size; row += 2) {
+			__m128i x = _mm_and_si128(_mm_loadu_si128((const __m128i*) (rows + row)), masks);
+			x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi64(x, 1), m1));
+			x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi64(x, 2), m2));
+			x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi64(x, 4)), m4);
+			// Sum of the bytes in each lane, i.e. the number of set bits in each row.
+			x = _mm_sad_epu8(x, zero);
+			sum = _mm_add_epi64(sum, _mm_mul_epu32(x, weights));
+			weights = _mm_add_epi64(weights, step);
+		}
+		int result = _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+		if (row < size) {
+			result += row * BitBoard::bitCount(rows[row] & mask);
+		}
+		return result;
+	}
+
+	int adjacentDifferenceSumSse2(const int* values, int size) {
+		__m128i sum = _mm_setzero_si128();
+
+		// Four differences at a time.
+		int i = 1;
+		for (; i + 3 < size; i += 4) {
+			__m128i diff = _mm_sub_epi32(_mm_loadu_si128((const __m128i*) (values + i)),
+				_mm_loadu_si128((const __m128i*) (values + i - 1)));
+			// Absolute value, SSE2 has no abs instruction.
+			__m128i sign = _mm_srai_epi32(diff, 31);
+			sum = _mm_add_epi32(sum, _mm_sub_epi32(_mm_xor_si128(diff, sign), sign));
+		}
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		int result = _mm_cvtsi128_si32(sum);
+		for (; i < size; ++i) {
+			result += std::abs(values[i] - values[i - 1]);
+		}
+		return result;
+	}
+#endif // FEATUREKERNELS_SSE2
+
+	bool detectSimd() {
+#if defined(FEATUREKERNELS_SSE2) && (defined(__GNUC__) || defined(__clang__))
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("sse2") != 0;
+#elif defined(FEATUREKERNELS_SSE2)
+		return true; // Part of the MSVC target.
+#else
+		return false;
+#endif
+	}
+
+	const bool SIMD_ENABLED = detectSimd();
+
+} // Anonymous namespace.
+
+int FeatureKernels::weightedBitCount(const std::uint64_t* rows, int size, std::uint64_t mask) {
+#ifdef FEATUREKERNELS_SSE2
+	if (SIMD_ENABLED) {
+		return weightedBitCountSse2(rows, size, mask);
+	}
+#endif
+	return weightedBitCountScalar(rows, size, mask);
+}
+
+int FeatureKernels::adjacentDifferenceSum(const int* values, int size) {
+#ifdef FEATUREKERNELS_SSE2
+	if (SIMD_ENABLED) {
+		return adjacentDifferenceSumSse2(values, size);
+	}
+#endif
+	return adjacentDifferenceSumScalar(values, size);
+}
+
+int FeatureKernels::weightedBitCountScalar(const std::uint64_t* rows, int size, std::uint64_t mask) {
+	int result = 0;
+	for (int row = 1; row < size; ++row) {
+		result += row * BitBoard::bitCount(rows[row] & mask);
+	}
+	return result;
+}
+
+int FeatureKernels::adjacentDifferenceSumScalar(const int* values, int size) {
+	int result = 0;
+	for (int i = 1; i < size; ++i) {
+		result += std::abs(values[i] - values[i - 1]);
+	}
+	return result;
+}
+
+bool FeatureKernels::isSimdEnabled() {
+	return SIMD_ENABLED;
+}
@@ -0,0 +1,25 @@
+#ifndef FEATUREKERNELS_H
+#define FEATUREKERNELS_H
+
+#include <cstdint>
+
+// Loops used when calculating the board features for the ai. The SSE2 versions are
+// selected at runtime when the cpu supports them, else the scalar versions are used.
+// Both versions give the same result.
+class FeatureKernels {
+public:
+	// Return the sum of row * (number of set bits in rows[row] & mask) for all rows in [0, size).
+	static int weightedBitCount(const std::uint64_t* rows, int size, std::uint64_t mask);
+
+	// Return the sum of |values[i] - values[i - 1]| for all i in [1, size).
+	static int adjacentDifferenceSum(const int* values, int size);
+
+	static int weightedBitCountScalar(const std::uint64_t* rows, int size, std::uint64_t mask);
+
+	static int adjacentDifferenceSumScalar(const int* values, int size);
+
+	// Return true if the SSE2 versions are used.
+	static bool isSimdEnabled();
+};
+
+#endif // FEATUREKERNELS_H
@@ -2,10 +2,26 @@
 #include "square.h"
 #include "block.h"
 
+#include <algorithm>
+
+namespace {
+
+	// The size must fit in the bit board.
+	int clampRows(int rows) {
+		return std::max(0, std::min(rows, BitBoard::MAX_ROWS));
+	}
+
+	int clampColumns(int columns) {
+		return std::max(1, std::min(columns, BitBoard::MAX_COLUMNS));
+	}
+
+} // Anonymous namespace.
+
 RawTetrisBoard::RawTetrisBoard(int rows, int columns, BlockType current, BlockType next) :
-	gameboard_(rows * columns, BlockType::EMPTY),
+	gameboard_(clampRows(rows) * clampColumns(columns), BlockType::EMPTY),
+	bitBoard_(clampRows(rows), clampColumns(columns)),
 	next_(next),
-	rows_(rows), columns_(columns),
+	rows_(clampRows(rows)), columns_(clampColumns(columns)),
 	isGameOver_(false),
 	rowsRemoved_(0),
 	externalRowsAdded_(0),
@@ -27,6 +43,7 @@ RawTetrisBoard::RawTetrisBoard(const std::vector<BlockType>& board, int rows, in
 	for (int i = 0; i < nbr; ++i) {
 		gameboard_.pop_back();
 	}
+	updateBitBoard();
 
 	// Remove unneeded rows. I.e. remove empty rows at the top which are outside the board.
 	for (int row = calcRows - 1; row >= rows_; --row) {
@@ -36,6 +53,7 @@ RawTetrisBoard::RawTetrisBoard(const std::vector<BlockType>& board, int rows, in
 			}
 		}
 	}
+	updateBitBoard();
 
 	if (collision(current)) {
 		isGameOver_ = true;
@@ -44,14 +62,7 @@ RawTetrisBoard::RawTetrisBoard(const std::vector<BlockType>& board, int rows, in
 }
 
 void RawTetrisBoard::update(Move move) {
-	// Game over?
-	if (isGameOver_ || collision(current_)) {
-		if (!isGameOver_) {
-			// Only called once when the game becomes game over.
-			isGameOver_ = true;
-			triggerEvent(GameEvent::GAME_OVER);
-		}
-	} else {
+	if (!updateGameOver()) {
 		Block block = current_;
 		switch (move) {
 			case Move::GAME_OVER:
@@ -106,40 +117,7 @@ void RawTetrisBoard::update(Move move) {
 				block.moveDown();
 				if (collision(block)) {
 					// Collision detected, add squares to the gameboard.
-					addBlockToBoard(current_);
-
-					triggerEvent(GameEvent::BLOCK_COLLISION);
-
-					// Remove any filled row on the gameboard.
-					int nbr = removeFilledRows(current_);
-					rowsRemoved_ += nbr;
-
-					// Add rows due to some external event.
-					std::vector<BlockType> squares = addExternalRows();
-					if (squares.size() > 0) {
-						externalRowsAdded_ = squares.size() / columns_;
-						gameboard_.insert(gameboard_.begin(), squares.begin(), squares.end());
-						triggerEvent(GameEvent::EXTERNAL_ROWS_ADDED);
-					}
-
-					// Update the user controlled block.
-					current_ = createBlock(next_);
-					triggerEvent(GameEvent::CURRENT_BLOCK_UPDATED);
-
-					switch (nbr) {
-						case 1:
-							triggerEvent(GameEvent::ONE_ROW_REMOVED);
-							break;
-						case 2:
-							triggerEvent(GameEvent::TWO_ROW_REMOVED);
-							break;
-						case 3:
-							triggerEvent(GameEvent::THREE_ROW_REMOVED);
-							break;
-						case 4:
-							triggerEvent(GameEvent::FOUR_ROW_REMOVED);
-							break;
-					}
+					landCurrentBlock();
 				} else {
 					current_ = block;
 					triggerEvent(GameEvent::GRAVITY_MOVES_BLOCK);
@@ -149,6 +127,105 @@ void RawTetrisBoard::update(Move move) {
 	}
 }
 
+void RawTetrisBoard::placeBlock(int rotationLeft, int column) {
+	if (updateGameOver()) {
+		return;
+	}
+
+	for (int i = 0; i < rotationLeft; ++i) {
+		Block block = current_;
+		block.rotateLeft();
+		if (!collision(block)) {
+			current_ = block;
+			triggerEvent(GameEvent::PLAYER_MOVES_BLOCK_ROTATE);
+		}
+	}
+
+	while (current_.getStartColumn() != column) {
+		Block block = current_;
+		bool left = column < current_.getStartColumn();
+		left ? block.moveLeft() : block.moveRight();
+		if (collision(block)) {
+			// Blocked, further moves in the same direction will fail too.
+			break;
+		}
+		current_ = block;
+		triggerEvent(left ? GameEvent::PLAYER_MOVES_BLOCK_LEFT : GameEvent::PLAYER_MOVES_BLOCK_RIGHT);
+	}
+
+	triggerEvent(GameEvent::PLAYER_MOVES_BLOCK_DOWN_GROUND);
+	int distance = bitBoard_.getDropDistance(current_);
+	for (int i = 0; i < distance; ++i) {
+		current_.moveDown();
+	}
+	triggerEvent(GameEvent::PLAYER_MOVES_BLOCK_DOWN);
+
+	// The block is on the ground, i.e. the same as a gravity move.
+	if (!updateGameOver()) {
+		landCurrentBlock();
+	}
+}
+
+bool RawTetrisBoard::updateGameOver() {
+	if (isGameOver_ || collision(current_)) {
+		if (!isGameOver_) {
+			// Only called once when the game becomes game over.
+			isGameOver_ = true;
+			triggerEvent(GameEvent::GAME_OVER);
+		}
+		return true;
+	}
+	return false;
+}
+
+void RawTetrisBoard::landCurrentBlock() {
+	addBlockToBoard(current_);
+
+	triggerEvent(GameEvent::BLOCK_COLLISION);
+
+	// Remove any filled row on the gameboard.
+	int nbr = removeFilledRows(current_);
+	rowsRemoved_ += nbr;
+
+	// Add rows due to some external event.
+	std::vector<BlockType> squares = addExternalRows();
+	if (squares.size() > 0) {
+		externalRowsAdded_ = squares.size() / columns_;
+		gameboard_.insert(gameboard_.begin(), squares.begin(), squares.end());
+		if ((int) gameboard_.size() > BitBoard::MAX_ROWS * columns_) {
+			// The top rows are too high to ever be reached by a block.
+			gameboard_.resize(BitBoard::MAX_ROWS * columns_);
+		}
+
+		std::vector<BitBoard::Row> rows(externalRowsAdded_);
+		for (int row = 0; row < externalRowsAdded_; ++row) {
+			auto begin = squares.begin() + row * columns_;
+			rows[row] = BitBoard::toRow(begin, begin + columns_);
+		}
+		bitBoard_.insertBottomRows(rows);
+		triggerEvent(GameEvent::EXTERNAL_ROWS_ADDED);
+	}
+
+	// Update the user controlled block.
+	current_ = createBlock(next_);
+	triggerEvent(GameEvent::CURRENT_BLOCK_UPDATED);
+
+	switch (nbr) {
+		case 1:
+			triggerEvent(GameEvent::ONE_ROW_REMOVED);
+			break;
+		case 2:
+			triggerEvent(GameEvent::TWO_ROW_REMOVED);
+			break;
+		case 3:
+			triggerEvent(GameEvent::THREE_ROW_REMOVED);
+			break;
+		case 4:
+			triggerEvent(GameEvent::FOUR_ROW_REMOVED);
+			break;
+	}
+}
+
 void RawTetrisBoard::updateNextBlock(BlockType nextBlock) {
 	next_ = nextBlock;
 	triggerEvent(GameEvent::NEXT_BLOCK_UPDATED);
@@ -166,8 +243,8 @@ void RawTetrisBoard::updateRestart(BlockType current, BlockType next) {
 void RawTetrisBoard::updateRestart(int rows, int columns, BlockType current, BlockType next) {
 	next_ = next;
 	current_ = createBlock(current);
-	rows_ = rows;
-	columns_ = columns;
+	rows_ = clampRows(rows);
+	columns_ = clampColumns(columns);
 	rowsRemoved_ = 0;
 	rowToBeRemoved_ = -1;
 	externalRowsAdded_ = 0;
@@ -175,19 +252,46 @@ void RawTetrisBoard::updateRestart(int rows, int columns, BlockType current, Blo
 	triggerEvent(GameEvent::RESTARTED);
 }
 
+void RawTetrisBoard::updateBoard(const std::vector<BlockType>& board, const Block& current, BlockType next) {
+	gameboard_.assign(board.begin(), board.end());
+	// Only whole rows, and at least the rows of the board.
+	int rows = std::max((int) gameboard_.size() / columns_, rows_);
+	gameboard_.resize(rows * columns_, BlockType::EMPTY);
+	updateBitBoard();
+	current_ = current;
+	next_ = next;
+	rowToBeRemoved_ = -1;
+	externalRowsAdded_ = 0;
+	triggerEvent(GameEvent::RESTARTED);
+}
+
 const std::vector<BlockType>& RawTetrisBoard::getBoardVector() const {
 	return gameboard_;
 }
 
+std::uint64_t RawTetrisBoard::getHash() const {
+	std::uint64_t blocks = (std::uint64_t) current_.getBlockType()
+		| (std::uint64_t) next_ << 4
+		| (std::uint64_t) current_.getCurrentRotation() << 8
+		| (std::uint64_t) (current_.getLowestStartRow() & 0xffff) << 16
+		| (std::uint64_t) (current_.getStartColumn() & 0xffff) << 32;
+	return bitBoard_.getHash() ^ BitBoard::mixHash(blocks);
+}
+
 void RawTetrisBoard::addBlockToBoard(const Block& block) {
 	// All squares in the block is added to the gameboard.
 	for (const Square& sq : block) {
 		blockType(sq.row_, sq.column_) = sq.blockType_;
+		bitBoard_.set(sq.row_, sq.column_);
 	}
 }
 
 Block RawTetrisBoard::createBlock(BlockType blockType) const {
-	return Block(blockType, rows_ - 4, columns_ / 2 - 1); // 4 rows are the starting area.
+	return createStartBlock(blockType, rows_, columns_);
+}
+
+Block RawTetrisBoard::createStartBlock(BlockType blockType, int rows, int columns) {
+	return Block(blockType, rows - 4, columns / 2 - 1); // 4 rows are the starting area.
 }
 
 BlockType RawTetrisBoard::getBlockType(int row, int column) const {
@@ -200,31 +304,33 @@ BlockType RawTetrisBoard::getBlockType(int row, int column) const {
 	return gameboard_[row * columns_ + column];
 }
 
-bool RawTetrisBoard::collision(const Block& block) const {
-	bool collision = false;
-
-	for (const Square& sq : block) {
-		if (getBlockType(sq.row_, sq.column_) != BlockType::EMPTY) {
-			collision = true;
-			break;
-		}
-	}
-
-	return collision;
-}
-
 void RawTetrisBoard::clearBoard() {
 	gameboard_.assign(rows_ * columns_, BlockType::EMPTY);
+	bitBoard_.clear(rows_, columns_);
 	isGameOver_ = false;
 }
 
+void RawTetrisBoard::updateBitBoard() {
+	if ((int) gameboard_.size() > BitBoard::MAX_ROWS * columns_) {
+		gameboard_.resize(BitBoard::MAX_ROWS * columns_);
+	}
+	int rows = gameboard_.size() / columns_;
+	bitBoard_.clear(0, columns_);
+	std::vector<BitBoard::Row> bits(rows);
+	for (int row = 0; row < rows; ++row) {
+		auto begin = gameboard_.begin() + row * columns_;
+		bits[row] = BitBoard::toRow(begin, begin + columns_);
+	}
+	bitBoard_.insertBottomRows(bits);
+}
+
 int RawTetrisBoard::removeFilledRows(const Block& block) {
 	int row = block.getLowestRow();
 	int nbr = 0; // Number of rows filled.
 	const int nbrOfSquares = current_.getSize();
 	for (int i = 0; i < nbrOfSquares; ++i) {
 		bool filled = false;
-		if (row >= 0 && row * columns_ < (int) gameboard_.size() ) { // Check only rows inside the board.			
+		if (row >= 0 && row < bitBoard_.getHeight()) { // Check only rows inside the board.
 			filled = isRowFilled(row);
 		}
 		if (filled) {
@@ -244,6 +350,7 @@ void RawTetrisBoard::moveRowsOneStepDown(int rowToRemove) {
 	int indexStartOfRow = rowToRemove * columns_;
 	// Erase the row.
 	gameboard_.erase(gameboard_.begin() + indexStartOfRow, gameboard_.begin() + indexStartOfRow + columns_);
+	bitBoard_.removeRow(rowToRemove, rows_);
 	
 	// Is it necessary to replace the row?
 	if ((int) gameboard_.size() < rows_ * columns_) {
@@ -2,7 +2,9 @@
 #define RAWTETRISBOARD_H
 
 #include "block.h"
+#include "bitboard.h"
 
+#include <cstdint>
 #include <vector>
 
 // The events triggered by the tetris board.
@@ -38,7 +40,9 @@ enum class Move {
 	GAME_OVER
 };
 
-// Represents a tetris board.
+// Represents a tetris board. The size is limited by the bit board, rows within
+// [0, BitBoard::MAX_ROWS] and columns within [1, BitBoard::MAX_COLUMNS], a size
+// outside is clamped to the limits.
 class RawTetrisBoard {
 public:
 	RawTetrisBoard(int rows, int columns, BlockType current, BlockType next);
@@ -49,6 +53,12 @@ public:
 	// Move the block. The board will stay constant if game over is true.
     void update(Move move);
 
+	// Place the current block directly. Rotate it left the number of times given, move it
+	// horizontally until the start column is reached and move it down to the ground where it
+	// becomes a part of the board. The board state and the triggered events are the same as
+	// when updating with ROTATE_LEFT, LEFT/RIGHT, DOWN_GROUND and DOWN_GRAVITY.
+	void placeBlock(int rotationLeft, int column);
+
 	// Update the next block to be. Triggers the game event NEXT_BLOCK_UPDATED.
 	void updateNextBlock(BlockType next);
 
@@ -58,7 +68,13 @@ public:
 
 	void updateRestart(BlockType current, BlockType next);
 
+	// Restart with a new size, clamped to the limits of the bit board.
 	void updateRestart(int rows, int columns, BlockType current, BlockType next);
+
+	// Replace the squares and the blocks, e.g. with the board of the same player in another
+	// connection. The size, the number of removed rows and game over are kept.
+	// Triggers the game event RESTARTED.
+	void updateBoard(const std::vector<BlockType>& board, const Block& current, BlockType next);
     
 	// Return the number of rows.
 	int getRows() const {
@@ -79,6 +95,16 @@ public:
 	// All squares are saved in row major order and in ascending order.
     const std::vector<BlockType>& getBoardVector() const;
 
+	// Return the occupancy of all non moving squares on the board.
+	const BitBoard& getBitBoard() const {
+		return bitBoard_;
+	}
+
+	// Return a hash of the occupied squares, the moving block and the next block, e.g. to
+	// compare with the same board in another connection. Cheap, the hash of the squares
+	// is updated incrementally. The block types of the squares are not included.
+	std::uint64_t getHash() const;
+
 	// Return the moving block.
 	Block getBlock() const {
 		return current_;
@@ -99,7 +125,9 @@ public:
 
 	// Return true if the block is outside or on an already occupied square on the board.
 	// Otherwise it return false.
-	bool collision(const Block& block) const;
+	bool collision(const Block& block) const {
+		return bitBoard_.collision(block);
+	}
 
 	int getNbrExternalRowsAdded() const {
 		return externalRowsAdded_;
@@ -113,6 +141,9 @@ public:
 		return rowToBeRemoved_;
 	}
 
+	// Return the block at the start position for a board of the given size.
+	static Block createStartBlock(BlockType blockType, int rows, int columns);
+
 private:
 	BlockType& blockType(int row, int column) {
 		return gameboard_[row * columns_ + column];
@@ -120,24 +151,24 @@ private:
 
 	Block createBlock(BlockType blockType) const;
 
+	// Return true if the game is over. Triggers the game event GAME_OVER when the
+	// current block collides for the first time.
+	bool updateGameOver();
+
+	// Add the current block to the board, remove filled rows and continue with the next block.
+	void landCurrentBlock();
+
 	bool isRowEmpty(int row) const {
-		for (int column = 0; column < columns_; ++column) {
-			if (gameboard_[row * columns_ + column] != BlockType::EMPTY) {
-				return false;
-			}
-		}
-		return true;
+		return bitBoard_.isRowEmpty(row);
 	}
 
 	bool isRowFilled(int row) const {
-		for (int column = 0; column < columns_; ++column) {
-			if (gameboard_[row * columns_ + column] == BlockType::EMPTY) {
-				return false;
-			}
-		}
-		return true;
+		return bitBoard_.isRowFilled(row);
 	}
 
+	// Rebuild the bit board from the block types in the gameboard.
+	void updateBitBoard();
+
 	// Set all squares on the board to empty.
 	// Game over is set to false.
 	void clearBoard();
@@ -160,6 +191,7 @@ private:
     void moveRowsOneStepDown(int rowToRemove);
     
 	std::vector<BlockType> gameboard_;	// Containing all non moving squares on the board.
+	BitBoard bitBoard_;					// The occupancy of gameboard_, one row per word.
 	BlockType next_;					// Next block for the player to control.
 	Block current_;						// The current block for the player to control.
 	int rows_, columns_;				// The size of the gameboard.
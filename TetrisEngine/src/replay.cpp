@@ -0,0 +1,294 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+	const char MAGIC[8] = {'T', 'R', 'E', 'P', 'L', 'A', 'Y', '1'};
+
+	const int CONTROL_PLAYER = 7;
+
+	enum Control {
+		GAME,
+		ROWS,
+		END
+	};
+
+	// Records are handed over to the background thread in chunks of this size.
+	const std::size_t SUBMIT_SIZE = 4096;
+
+	void writeVarint(std::string& data, std::uint64_t value) {
+		while (value >= 0x80) {
+			data.push_back((char) ((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		data.push_back((char) value);
+	}
+
+	// Return false if the data ends before the varint.
+	bool readVarint(const std::string& data, std::size_t& index, std::uint64_t& value) {
+		value = 0;
+		for (int shift = 0; shift < 64 && index < data.size(); shift += 7) {
+			const unsigned char byte = data[index++];
+			value |= (std::uint64_t) (byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool readInt(const std::string& data, std::size_t& index, int& value, int max) {
+		std::uint64_t tmp;
+		if (!readVarint(data, index, tmp) || tmp > (std::uint64_t) max) {
+			return false;
+		}
+		value = (int) tmp;
+		return true;
+	}
+
+} // Anonymous namespace.
+
+bool Replay::read(const std::string& file, std::vector<Game>& games) {
+	std::ifstream infile(file, std::ios::binary);
+	const std::string data((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+	if (data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+		return false;
+	}
+
+	std::size_t index = sizeof(MAGIC);
+	Game* game = nullptr;
+	int tick = 0;
+	std::uint64_t key;
+	while (readVarint(data, index, key)) {
+		const int player = (key >> 3) & 7;
+		const int code = key & 7;
+		tick += (int) (key >> 6);
+		if (player != CONTROL_PLAYER) {
+			if (game != nullptr && player < (int) game->seeds_.size()) {
+				game->events_.push_back(Event{tick, player, EventType::MOVE, (Move) code, {}});
+			}
+		} else if (code == GAME) {
+			int rows, columns, mode, microseconds, players;
+			if (!readInt(data, index, rows, BitBoard::MAX_ROWS) || !readInt(data, index, columns, BitBoard::MAX_COLUMNS)
+				|| !readInt(data, index, mode, 1) || !readInt(data, index, microseconds, 1000000000)
+				|| !readInt(data, index, players, MAX_PLAYERS)) {
+				break;
+			}
+			std::vector<std::uint64_t> seeds(players);
+			bool valid = true;
+			for (std::uint64_t& seed : seeds) {
+				valid = valid && readVarint(data, index, seed);
+			}
+			if (!valid) {
+				break;
+			}
+			games.push_back(Game{rows, columns, (BlockGenerator::Mode) mode, microseconds * 1e-6, seeds, {}});
+			game = &games.back();
+			tick = 0;
+		} else if (code == ROWS) {
+			int rowsPlayer, size;
+			if (!readInt(data, index, rowsPlayer, MAX_PLAYERS) || !readInt(data, index, size, BitBoard::MAX_ROWS * BitBoard::MAX_COLUMNS)
+				|| index + (size + 1) / 2 > data.size()) {
+				break;
+			}
+			std::vector<BlockType> blockTypes(size);
+			for (int i = 0; i < size; ++i) {
+				const unsigned char byte = data[index + i / 2];
+				blockTypes[i] = (BlockType) (i % 2 == 0 ? byte & 0x0f : byte >> 4);
+			}
+			index += (size + 1) / 2;
+			if (game != nullptr && rowsPlayer < (int) game->seeds_.size()) {
+				game->events_.push_back(Event{tick, rowsPlayer, EventType::ROWS, Move::GAME_OVER, blockTypes});
+			}
+		} else if (code == END) {
+			game = nullptr;
+		} else {
+			break;
+		}
+	}
+	return true;
+}
+
+ReplayWriter::ReplayWriter() : file_(nullptr), stop_(false), active_(false), players_(0), tick_(0), lastTick_(0) {
+}
+
+ReplayWriter::~ReplayWriter() {
+	close();
+}
+
+bool ReplayWriter::open(const std::string& file) {
+	close();
+
+	// Append if the existing file is a replay file.
+	if (std::FILE* existing = std::fopen(file.c_str(), "rb")) {
+		char header[sizeof(MAGIC)];
+		const bool same = std::fread(header, 1, sizeof(header), existing) == sizeof(header)
+			&& std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0;
+		std::fclose(existing);
+		if (same) {
+			file_ = std::fopen(file.c_str(), "ab");
+		}
+	}
+	if (file_ == nullptr) {
+		file_ = std::fopen(file.c_str(), "wb");
+		if (file_ != nullptr && std::fwrite(MAGIC, 1, sizeof(MAGIC), file_) != sizeof(MAGIC)) {
+			std::fclose(file_);
+			file_ = nullptr;
+		}
+	}
+	if (file_ == nullptr) {
+		return false;
+	}
+	stop_ = false;
+	thread_ = std::thread(&ReplayWriter::run, this);
+	return true;
+}
+
+void ReplayWriter::close() {
+	if (file_ == nullptr) {
+		return;
+	}
+	endGame();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	condition_.notify_one();
+	thread_.join();
+	std::fclose(file_);
+	file_ = nullptr;
+}
+
+void ReplayWriter::startGame(int rows, int columns, BlockGenerator::Mode mode, double timeStep, const std::vector<std::uint64_t>& seeds) {
+	endGame();
+	if (file_ == nullptr || seeds.size() > (std::size_t) Replay::MAX_PLAYERS) {
+		return;
+	}
+	tick_ = 0;
+	lastTick_ = 0;
+	writeKey(CONTROL_PLAYER, GAME);
+	writeVarint(buffer_, rows);
+	writeVarint(buffer_, columns);
+	writeVarint(buffer_, (int) mode);
+	writeVarint(buffer_, (std::uint64_t) std::lround(timeStep * 1e6));
+	writeVarint(buffer_, seeds.size());
+	for (std::uint64_t seed : seeds) {
+		writeVarint(buffer_, seed);
+	}
+	active_ = true;
+	players_ = (int) seeds.size();
+}
+
+void ReplayWriter::endGame() {
+	if (active_) {
+		writeKey(CONTROL_PLAYER, END);
+		active_ = false;
+		submit();
+	}
+}
+
+void ReplayWriter::nextTick() {
+	++tick_;
+	if (buffer_.size() >= SUBMIT_SIZE) {
+		submit();
+	}
+}
+
+void ReplayWriter::addMove(int player, Move move) {
+	if (active_ && player >= 0 && player < players_) {
+		writeKey(player, (int) move);
+	}
+}
+
+void ReplayWriter::addRows(int player, const std::vector<BlockType>& blockTypes) {
+	if (active_ && player >= 0 && player < players_) {
+		writeKey(CONTROL_PLAYER, ROWS);
+		writeVarint(buffer_, player);
+		writeVarint(buffer_, blockTypes.size());
+		for (std::size_t i = 0; i < blockTypes.size(); i += 2) {
+			int byte = (int) blockTypes[i];
+			if (i + 1 < blockTypes.size()) {
+				byte |= (int) blockTypes[i + 1] << 4;
+			}
+			buffer_.push_back((char) byte);
+		}
+	}
+}
+
+void ReplayWriter::writeKey(int player, int code) {
+	writeVarint(buffer_, (std::uint64_t) (tick_ - lastTick_) << 6 | (player << 3) | code);
+	lastTick_ = tick_;
+}
+
+void ReplayWriter::submit() {
+	if (buffer_.empty()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		pending_.append(buffer_);
+	}
+	buffer_.clear();
+	condition_.notify_one();
+}
+
+void ReplayWriter::run() {
+	std::string data;
+	bool stop = false;
+	while (!stop) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [&]() {
+				return stop_ || !pending_.empty();
+			});
+			data.swap(pending_);
+			stop = stop_;
+		}
+		if (!data.empty()) {
+			std::fwrite(data.data(), 1, data.size(), file_);
+			std::fflush(file_);
+			data.clear();
+		}
+	}
+}
+
+ReplayPlayer::ReplayPlayer(const Replay::Game& game) : game_(game), index_(0), tick_(0) {
+	for (std::uint64_t seed : game.seeds_) {
+		// The same way as for a local player.
+		BlockGenerator blockGenerator(seed, game.mode_);
+		BlockType current = blockGenerator.generateBlockType();
+		BlockType next = blockGenerator.generateBlockType();
+		boards_.push_back(std::make_unique<TetrisBoard>(game.rows_, game.columns_, current, next));
+		TetrisBoard* board = boards_.back().get();
+		board->setBlockGenerator(blockGenerator);
+		board->addGameEventListener([board](GameEvent gameEvent, const TetrisBoard&) {
+			if (gameEvent == GameEvent::CURRENT_BLOCK_UPDATED) {
+				board->updateNextBlock(board->getBlockGenerator().generateBlockType());
+			}
+		});
+	}
+}
+
+void ReplayPlayer::update(int tick) {
+	while (index_ < game_.events_.size() && game_.events_[index_].tick_ <= tick) {
+		const Replay::Event& event = game_.events_[index_++];
+		TetrisBoard& board = *boards_[event.player_];
+		if (event.type_ == Replay::EventType::MOVE) {
+			board.update(event.move_);
+		} else {
+			board.addRows(event.rows_);
+		}
+	}
+	tick_ = std::max(tick_, tick);
+}
+
+void ReplayPlayer::runToEnd() {
+	if (!game_.events_.empty()) {
+		update(game_.events_.back().tick_);
+	}
+}
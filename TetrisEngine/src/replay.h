@@ -0,0 +1,158 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "blockgenerator.h"
+#include "tetrisboard.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Games recorded as the seed of each player and the moves, i.e. the boards are
+// reproduced by playing the moves again.
+//
+// File: "TREPLAY1" followed by records. Each record starts with a varint key,
+// (ticks since the last record << 6) | (player << 3) | move. Player 7 marks a
+// control record with the type in place of the move:
+// GAME: rows, columns, block generator mode, microseconds per tick, players and
+// the seed of each player, all varints. The tick is reset to 0.
+// ROWS: player, number of squares and the block types, two in each byte.
+// END: the game is over, moves are not recorded until the next game.
+class Replay {
+public:
+	enum class EventType {
+		MOVE,
+		ROWS
+	};
+
+	struct Event {
+		int tick_;
+		int player_;
+		EventType type_;
+		Move move_;
+		std::vector<BlockType> rows_; // Only for EventType::ROWS.
+	};
+
+	struct Game {
+		int rows_;
+		int columns_;
+		BlockGenerator::Mode mode_;
+		double timeStep_; // Seconds per tick.
+		std::vector<std::uint64_t> seeds_;
+		std::vector<Event> events_;
+
+		// Return the game length in seconds.
+		double getSeconds() const {
+			return events_.empty() ? 0 : events_.back().tick_ * timeStep_;
+		}
+	};
+
+	static const int MAX_PLAYERS = 7;
+
+	// Add the games in the file to the vector. A game cut short, e.g. by a crash,
+	// is added with the events written before. Return false if not a replay file.
+	static bool read(const std::string& file, std::vector<Game>& games);
+};
+
+// Records games to a file. The records are buffered and written by a background
+// thread, i.e. the game thread never waits for the file. All calls, except the
+// constructor and destructor, must be made from the same thread.
+class ReplayWriter {
+public:
+	ReplayWriter();
+	~ReplayWriter();
+
+	ReplayWriter(const ReplayWriter&) = delete;
+	ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+	// Append to the replay file, it is created if missing. Return false on failure.
+	bool open(const std::string& file);
+
+	// Write all recorded games and stop the background thread.
+	void close();
+
+	bool isOpen() const {
+		return file_ != nullptr;
+	}
+
+	// Start recording a new game, ends the current game. Player i uses a block
+	// generator with seeds[i] and the mode, at most Replay::MAX_PLAYERS players.
+	void startGame(int rows, int columns, BlockGenerator::Mode mode, double timeStep, const std::vector<std::uint64_t>& seeds);
+
+	// Stop recording the current game, e.g. when the boards are changed in a way
+	// not possible to replay.
+	void endGame();
+
+	// Call once for each fixed time step in the game.
+	void nextTick();
+
+	void addMove(int player, Move move);
+
+	// Rows added to the player board by the other players.
+	void addRows(int player, const std::vector<BlockType>& blockTypes);
+
+private:
+	void writeKey(int player, int code);
+
+	// Hand the buffered records over to the background thread.
+	void submit();
+
+	void run();
+
+	std::FILE* file_;
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::string buffer_;  // Only used by the game thread.
+	std::string pending_; // Guarded by the mutex.
+	bool stop_;           // Guarded by the mutex.
+	bool active_;
+	int players_;
+	int tick_;
+	int lastTick_;
+};
+
+// Plays the moves of a recorded game on new boards, as fast as possible. The game
+// must outlive the player.
+class ReplayPlayer {
+public:
+	explicit ReplayPlayer(const Replay::Game& game);
+
+	ReplayPlayer(const ReplayPlayer&) = delete;
+	ReplayPlayer& operator=(const ReplayPlayer&) = delete;
+
+	// Play all events up to and including the tick.
+	void update(int tick);
+
+	// Play all remaining events.
+	void runToEnd();
+
+	bool isFinished() const {
+		return index_ >= game_.events_.size();
+	}
+
+	int getTick() const {
+		return tick_;
+	}
+
+	int getNbrOfPlayers() const {
+		return boards_.size();
+	}
+
+	const TetrisBoard& getTetrisBoard(int player) const {
+		return *boards_[player];
+	}
+
+private:
+	const Replay::Game& game_;
+	std::vector<std::unique_ptr<TetrisBoard>> boards_;
+	std::size_t index_;
+	int tick_;
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,162 @@
+#include "simulation.h"
+#include "tetrisboard.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+	// The blocks for one game, from the block list or else from the seed.
+	class BlockSource {
+	public:
+		explicit BlockSource(const Simulation::Game& game) : blockGenerator_(game.seed_, game.mode_), index_(0) {
+			if (game.blockTypes_ && !game.blockTypes_->empty()) {
+				blockTypes_ = game.blockTypes_.get();
+			} else {
+				blockTypes_ = nullptr;
+			}
+		}
+
+		BlockType next() {
+			if (blockTypes_ != nullptr) {
+				BlockType blockType = (*blockTypes_)[index_];
+				index_ = (index_ + 1) % blockTypes_->size();
+				return blockType;
+			}
+			return blockGenerator_.generateBlockType();
+		}
+
+	private:
+		const std::vector<BlockType>* blockTypes_;
+		BlockGenerator blockGenerator_;
+		std::size_t index_;
+	};
+
+} // Anonymous namespace.
+
+double Simulation::Summary::getMeanTurns() const {
+	return games_ > 0 ? (double) turns_ / games_ : 0;
+}
+
+double Simulation::Summary::getGamesPerSecond() const {
+	return seconds_ > 0 ? games_ / seconds_ : 0;
+}
+
+double Simulation::Summary::getPlacementsPerSecond() const {
+	return seconds_ > 0 ? turns_ / seconds_ : 0;
+}
+
+double Simulation::Summary::getTableHitRate() const {
+	std::uint64_t lookups = tableCounters_.hits_ + tableCounters_.misses_;
+	return lookups > 0 ? (double) tableCounters_.hits_ / lookups : 0;
+}
+
+Simulation::Simulation(int rows, int columns, int maxTurns, int depth) : rows_(rows), columns_(columns),
+	maxTurns_(maxTurns), depth_(depth) {
+}
+
+Simulation::GameResult Simulation::run(const Ai& ai, const Game& game) const {
+	ThreadPool serialPool(0);
+	Ai::Workspace workspace = ai.createWorkspace(serialPool);
+	return run(ai, game, serialPool, workspace);
+}
+
+std::vector<Simulation::GameResult> Simulation::run(const Ai& ai, const std::vector<Game>& games, ThreadPool& threadPool) const {
+	return run(std::vector<const Ai*>{&ai}, games, threadPool);
+}
+
+std::vector<Simulation::GameResult> Simulation::run(const std::vector<Ai>& ais, const std::vector<Game>& games, ThreadPool& threadPool) const {
+	std::vector<const Ai*> aiPointers;
+	for (const Ai& ai : ais) {
+		aiPointers.push_back(&ai);
+	}
+	return run(aiPointers, games, threadPool);
+}
+
+std::vector<Simulation::GameResult> Simulation::run(const std::vector<const Ai*>& ais, const std::vector<Game>& games, ThreadPool& threadPool) const {
+	// The searches inside a game are serial, the games are run in parallel. Each
+	// worker keeps its workspace as long as the next game is for the same ai.
+	struct Worker {
+		const Ai* ai_;
+		std::unique_ptr<Ai::Workspace> workspace_;
+	};
+	ThreadPool serialPool(0);
+	std::vector<Worker> workers(threadPool.getNbrOfWorkers() + 1);
+
+	std::vector<GameResult> results(ais.size() * games.size());
+	threadPool.parallelFor(results.size(), [&](int index) {
+		const Ai& ai = *ais[index / games.size()];
+		Worker& worker = workers[threadPool.getWorkerIndex() + 1];
+		if (worker.ai_ != &ai) {
+			worker.ai_ = &ai;
+			worker.workspace_ = std::make_unique<Ai::Workspace>(ai.createWorkspace(serialPool));
+		}
+		results[index] = run(ai, games[index % games.size()], serialPool, *worker.workspace_);
+	});
+	return results;
+}
+
+Simulation::Summary Simulation::summarize(const std::vector<GameResult>& results, double seconds) {
+	Summary summary{};
+	summary.games_ = results.size();
+	summary.seconds_ = seconds;
+	summary.minTurns_ = results.empty() ? 0 : results.front().turns_;
+	for (const GameResult& result : results) {
+		summary.turns_ += result.turns_;
+		summary.minTurns_ = std::min(summary.minTurns_, result.turns_);
+		summary.maxTurns_ = std::max(summary.maxTurns_, result.turns_);
+		for (int i = 0; i < 4; ++i) {
+			summary.removedRows_[i] += result.removedRows_[i];
+		}
+		summary.tableCounters_ += result.tableCounters_;
+	}
+	return summary;
+}
+
+Simulation::GameResult Simulation::run(const Ai& ai, const Game& game, ThreadPool& serialPool, Ai::Workspace& workspace) const {
+	BlockSource blockSource(game);
+	BlockType current = blockSource.next();
+	BlockType next = blockSource.next();
+	TetrisBoard board(rows_, columns_, current, next);
+
+	GameResult result{};
+	board.addGameEventListener([&](GameEvent gameEvent, const TetrisBoard&) {
+		switch (gameEvent) {
+			case GameEvent::BLOCK_COLLISION:
+				board.updateNextBlock(blockSource.next());
+				break;
+			case GameEvent::ONE_ROW_REMOVED:
+				++result.removedRows_[0];
+				break;
+			case GameEvent::TWO_ROW_REMOVED:
+				++result.removedRows_[1];
+				break;
+			case GameEvent::THREE_ROW_REMOVED:
+				++result.removedRows_[2];
+				break;
+			case GameEvent::FOUR_ROW_REMOVED:
+				++result.removedRows_[3];
+				break;
+			default:
+				break;
+		}
+	});
+
+	const int depth = ai.getDepth() > 0 ? ai.getDepth() : depth_;
+	const TranspositionTable::Counters tableCounters = workspace.getTableCounters();
+	auto time = std::chrono::steady_clock::now();
+	while (!board.isGameOver() && board.getTurns() < maxTurns_) {
+		Ai::State state = ai.calculateBestState(board.getBitBoard(), board.getBlock(), board.getNextBlockType(),
+			board.getRows(), depth, serialPool, workspace);
+
+		// Rotate, move side-ways and down to the ground.
+		board.placeBlock(state.rotationLeft_, board.getBlock().getStartColumn() - state.left_);
+	}
+	std::chrono::duration<double> delta = std::chrono::steady_clock::now() - time;
+	result.turns_ = board.getTurns();
+	result.seconds_ = delta.count();
+	result.tableCounters_ = workspace.getTableCounters();
+	result.tableCounters_.hits_ -= tableCounters.hits_;
+	result.tableCounters_.misses_ -= tableCounters.misses_;
+	return result;
+}
@@ -0,0 +1,84 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "ai.h"
+#include "block.h"
+#include "blockgenerator.h"
+#include "threadpool.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Runs complete games without graphics, the ai places every block directly.
+// Used to compare and tune value functions over many games.
+class Simulation {
+public:
+	// Where a game gets its blocks from.
+	struct Game {
+		// Blocks generated from the seed, used if blockTypes_ is null or empty.
+		std::uint64_t seed_;
+		// Blocks read in order, restarting from the beginning when all are used.
+		std::shared_ptr<const std::vector<BlockType>> blockTypes_;
+		BlockGenerator::Mode mode_;
+	};
+
+	// The result of one game.
+	struct GameResult {
+		int turns_;
+		// The number of times one, two, three and four rows were removed at once.
+		std::array<int, 4> removedRows_;
+		double seconds_;
+		// The lookups in the transposition table during the game.
+		TranspositionTable::Counters tableCounters_;
+	};
+
+	// The results of all games added together.
+	struct Summary {
+		int games_;
+		long long turns_;
+		int minTurns_;
+		int maxTurns_;
+		std::array<long long, 4> removedRows_;
+		// The wall clock time for all games.
+		double seconds_;
+		TranspositionTable::Counters tableCounters_;
+
+		double getMeanTurns() const;
+		double getGamesPerSecond() const;
+		double getPlacementsPerSecond() const;
+
+		// Return the part of the lookups in the transposition table found.
+		double getTableHitRate() const;
+	};
+
+	// A game ends when it is game over or after maxTurns blocks. The ai looks depth
+	// blocks ahead, unless the ai defines its own depth.
+	Simulation(int rows, int columns, int maxTurns, int depth);
+
+	// Play one game. The search is done in the calling thread.
+	GameResult run(const Ai& ai, const Game& game) const;
+
+	// Play all games as tasks in the thread pool, each game in one task. Result i
+	// belongs to game i, i.e. the order is the same for any number of workers.
+	std::vector<GameResult> run(const Ai& ai, const std::vector<Game>& games, ThreadPool& threadPool) const;
+
+	// Play all games for each ai, all in one batch of tasks to keep the workers
+	// busy. Result i * games.size() + j belongs to ai i and game j.
+	std::vector<GameResult> run(const std::vector<Ai>& ais, const std::vector<Game>& games, ThreadPool& threadPool) const;
+
+	static Summary summarize(const std::vector<GameResult>& results, double seconds);
+
+private:
+	std::vector<GameResult> run(const std::vector<const Ai*>& ais, const std::vector<Game>& games, ThreadPool& threadPool) const;
+
+	GameResult run(const Ai& ai, const Game& game, ThreadPool& serialPool, Ai::Workspace& workspace) const;
+
+	int rows_;
+	int columns_;
+	int maxTurns_;
+	int depth_;
+};
+
+#endif // SIMULATION_H
@@ -6,25 +6,31 @@
 
 #include <vector>
 #include <queue>
-#include <random>
+
+namespace {
+
+	BlockGenerator& getThreadBlockGenerator() {
+		// Seeded once for each thread.
+		thread_local BlockGenerator blockGenerator;
+		return blockGenerator;
+	}
+
+} // Anonymous namespace.
 
 BlockType randomBlockType() {
-	Random random;
-	const int BLOCK_TYPE_MIN = 0;
-	const int BLOCK_TYPE_MAX = 6;
-	static_assert((int) BlockType::EMPTY > BLOCK_TYPE_MAX && 
-		(int) BlockType::WALL > BLOCK_TYPE_MAX, "BlockType::EMPTY should not be generated");
-	// Generate a block type.
-	return static_cast<BlockType>(random.generateInt(BLOCK_TYPE_MIN, BLOCK_TYPE_MAX));
+	return getThreadBlockGenerator().generateBlockType();
 }
 
 std::vector<BlockType> generateRow(const RawTetrisBoard& board, double squaresPerLength) {
+	return generateRow(board, squaresPerLength, getThreadBlockGenerator());
+}
+
+std::vector<BlockType> generateRow(const RawTetrisBoard& board, double squaresPerLength, BlockGenerator& blockGenerator) {
 	const unsigned int size = board.getColumns();
 
-	Random random;
 	std::vector<bool> row(size);
 	for (unsigned int i = 0; i < size * squaresPerLength; ++i) {
-		int index = random.generateInt(0, size - 1);
+		int index = blockGenerator.generateInt(0, size - 1);
 		unsigned int nbr = 0;
 		while (nbr < size) {
 			if (!row[(index + nbr) % size]) {
@@ -43,7 +49,7 @@ std::vector<BlockType> generateRow(const RawTetrisBoard& board, double squaresPe
 		// Fill square?
 		if (row[i]) {
 			// Generate a block type.
-			blockType = randomBlockType();
+			blockType = blockGenerator.generateBlockType();
 		}
 		rows.push_back(blockType);
 	}
@@ -60,7 +66,7 @@ TetrisBoard::TetrisBoard(const std::vector<BlockType>& board, int rows, int colu
 }
 
 TetrisBoard::TetrisBoard(const TetrisBoard& board)
-	: RawTetrisBoard(board) {
+	: RawTetrisBoard(board), blockGenerator_(board.blockGenerator_) {
 }
 
 void TetrisBoard::restart(BlockType current, BlockType next) {
@@ -75,6 +81,9 @@ void TetrisBoard::triggerEvent(GameEvent gameEvent) {
 		case GameEvent::NEXT_BLOCK_UPDATED:
 			// Assumes a new turn.
 			++turns_;
+			if (boardCorpusWriter_ && !isGameOver()) {
+				boardCorpusWriter_->write(*this);
+			}
 			break;
 	}
 }
@@ -2,17 +2,23 @@
 #define TETRISBOARD_H
 
 #include "block.h"
+#include "blockgenerator.h"
+#include "boardcorpus.h"
 #include "rawtetrisboard.h"
-#include "random.h"
 
 #include <mw/signal.h>
 
+#include <memory>
 #include <vector>
 
+// Use a generator shared by all calls in the calling thread.
 BlockType randomBlockType();
 
+// Use the generator shared by all calls in the calling thread, i.e. not reproducible.
 std::vector<BlockType> generateRow(const RawTetrisBoard& board, double squaresPerLength);
 
+std::vector<BlockType> generateRow(const RawTetrisBoard& board, double squaresPerLength, BlockGenerator& blockGenerator);
+
 // Represents a tetris board.
 class TetrisBoard : public RawTetrisBoard {
 public:
@@ -34,6 +40,25 @@ public:
 
 	mw::signals::Connection addGameEventListener(const std::function<void(GameEvent, const TetrisBoard&)>& callback);
 
+	// The generator for the blocks in this game.
+	BlockGenerator& getBlockGenerator() {
+		return blockGenerator_;
+	}
+
+	const BlockGenerator& getBlockGenerator() const {
+		return blockGenerator_;
+	}
+
+	void setBlockGenerator(const BlockGenerator& blockGenerator) {
+		blockGenerator_ = blockGenerator;
+	}
+
+	// Save the position at the start of each turn to the corpus, null to stop
+	// saving. The writer is not copied together with the board.
+	void setBoardCorpusWriter(const std::shared_ptr<BoardCorpusWriter>& boardCorpusWriter) {
+		boardCorpusWriter_ = boardCorpusWriter;
+	}
+
 private:
 	// @RawTetrisBoard
 	void triggerEvent(GameEvent gameEvent) override;
@@ -45,7 +70,8 @@ private:
 	mw::Signal<GameEvent, const TetrisBoard&> listener_;
 	
 	int turns_;
-	Random random_;
+	BlockGenerator blockGenerator_;
+	std::shared_ptr<BoardCorpusWriter> boardCorpusWriter_;
 };
 
 #endif // TETRISBOARD_H
@@ -0,0 +1,118 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+namespace {
+
+	// The pool and worker index for the calling thread.
+	thread_local const ThreadPool* currentPool = nullptr;
+	thread_local int currentIndex = -1;
+
+} // Anonymous namespace.
+
+ThreadPool::ThreadPool(int workers) : pending_(0), nextQueue_(0), stop_(false) {
+	workers = std::max(0, workers);
+	for (int i = 0; i < workers; ++i) {
+		queues_.push_back(std::make_unique<Queue>());
+	}
+	for (int i = 0; i < workers; ++i) {
+		threads_.emplace_back(&ThreadPool::run, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	condition_.notify_all();
+	for (std::thread& thread : threads_) {
+		thread.join();
+	}
+}
+
+int ThreadPool::getWorkerIndex() const {
+	return currentPool == this ? currentIndex : -1;
+}
+
+int ThreadPool::getDefaultNbrOfWorkers() {
+	// Leave one hardware thread for the thread waiting for the tasks.
+	return std::max(1, (int) std::thread::hardware_concurrency() - 1);
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+	if (threads_.empty()) {
+		task();
+	} else {
+		push(std::move(task));
+	}
+}
+
+void ThreadPool::push(Task task) {
+	int index = getWorkerIndex();
+	if (index < 0) {
+		index = nextQueue_++ % queues_.size();
+	}
+	{
+		std::lock_guard<std::mutex> lock(queues_[index]->mutex_);
+		queues_[index]->tasks_.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++pending_;
+	}
+	condition_.notify_one();
+}
+
+bool ThreadPool::tryPop(int index, bool newest, Task& task) {
+	Queue& queue = *queues_[index];
+	std::lock_guard<std::mutex> lock(queue.mutex_);
+	if (queue.tasks_.empty()) {
+		return false;
+	}
+	if (newest) {
+		task = std::move(queue.tasks_.back());
+		queue.tasks_.pop_back();
+	} else {
+		task = std::move(queue.tasks_.front());
+		queue.tasks_.pop_front();
+	}
+	--pending_;
+	return true;
+}
+
+bool ThreadPool::tryRunTask() {
+	const int size = queues_.size();
+	const int index = getWorkerIndex();
+	Task task;
+	bool found = index >= 0 && tryPop(index, true, task);
+	// Steal from the other queues.
+	const int start = index >= 0 ? index + 1 : 0;
+	for (int i = 0; !found && i < size; ++i) {
+		int other = (start + i) % size;
+		if (other != index) {
+			found = tryPop(other, false, task);
+		}
+	}
+	if (found) {
+		task();
+	}
+	return found;
+}
+
+void ThreadPool::run(int index) {
+	currentPool = this;
+	currentIndex = index;
+	while (true) {
+		if (tryRunTask()) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mutex_);
+		condition_.wait(lock, [&]() {
+			return stop_ || pending_ > 0;
+		});
+		if (stop_ && pending_ == 0) {
+			return;
+		}
+	}
+}
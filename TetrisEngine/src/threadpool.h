@@ -0,0 +1,127 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A pool of worker threads with one task queue per worker. A worker takes the
+// newest task from its own queue and steals the oldest task from the other
+// queues when its own queue is empty.
+class ThreadPool {
+public:
+	// Create a pool with the number of worker threads. With no workers all tasks
+	// are run by the thread waiting for them.
+	explicit ThreadPool(int workers);
+
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	int getNbrOfWorkers() const {
+		return threads_.size();
+	}
+
+	// Return the index of the worker running the calling thread, or -1 if the
+	// calling thread is not a worker in this pool.
+	int getWorkerIndex() const;
+
+	// Call function(index) for all index in [0, size) and return when all calls are
+	// done. The indices are taken one at a time by the calling thread and by helper
+	// tasks in the workers. The calling thread only helps with this loop, i.e. never
+	// waits behind an unrelated task, and blocks when all indices are taken. Safe to
+	// call from inside a task.
+	template <class Function>
+	void parallelFor(int size, const Function& function);
+
+	// Add the task to the pool and return without waiting for it. With no workers
+	// the task is run directly by the calling thread.
+	void submit(std::function<void()> task);
+
+	// Return the number of workers to use when nothing else is defined.
+	static int getDefaultNbrOfWorkers();
+
+private:
+	using Task = std::function<void()>;
+
+	struct Queue {
+		std::mutex mutex_;
+		std::deque<Task> tasks_;
+	};
+
+	void push(Task task);
+
+	// Run one task from the queues. Return false if no task was found.
+	bool tryRunTask();
+
+	bool tryPop(int index, bool newest, Task& task);
+
+	void run(int index);
+
+	std::vector<std::unique_ptr<Queue>> queues_;
+	std::vector<std::thread> threads_;
+	std::atomic<int> pending_;
+	std::atomic<unsigned int> nextQueue_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	bool stop_;
+};
+
+template <class Function>
+void ThreadPool::parallelFor(int size, const Function& function) {
+	if (threads_.empty()) {
+		for (int i = 0; i < size; ++i) {
+			function(i);
+		}
+		return;
+	}
+
+	struct Loop {
+		Loop(const Function& function, int size) : function_(function), size_(size), next_(0), remaining_(size) {
+		}
+
+		// Run the indices not yet taken, return when none are left.
+		void run() {
+			for (int index = next_++; index < size_; index = next_++) {
+				function_(index);
+				if (--remaining_ == 0) {
+					std::lock_guard<std::mutex> lock(mutex_);
+					condition_.notify_all();
+				}
+			}
+		}
+
+		const Function& function_;
+		const int size_;
+		std::atomic<int> next_;
+		std::atomic<int> remaining_;
+		std::mutex mutex_;
+		std::condition_variable condition_;
+	};
+
+	// A helper task may start after the loop is done, i.e. it keeps the loop alive
+	// but finds no index left and never calls the function.
+	auto loop = std::make_shared<Loop>(function, size);
+	const int helpers = std::min(size - 1, (int) threads_.size());
+	for (int i = 0; i < helpers; ++i) {
+		push([loop]() {
+			loop->run();
+		});
+	}
+	loop->run();
+
+	// The indices left are run by the workers.
+	std::unique_lock<std::mutex> lock(loop->mutex_);
+	loop->condition_.wait(lock, [&]() {
+		return loop->remaining_ == 0;
+	});
+}
+
+#endif // THREADPOOL_H
@@ -0,0 +1,56 @@
+#include "transpositiontable.h"
+
+#include <cstring>
+
+namespace {
+
+	// Marks the data in an entry as used, an empty entry has no data.
+	const std::uint64_t USED_BIT = std::uint64_t(1) << 32;
+
+	std::uint64_t toData(float value) {
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return USED_BIT | bits;
+	}
+
+	float toValue(std::uint64_t data) {
+		std::uint32_t bits = (std::uint32_t) data;
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+} // Anonymous namespace.
+
+TranspositionTable::TranspositionTable(int sizeLog2) : entries_(std::size_t(1) << sizeLog2),
+	mask_((std::uint64_t(1) << sizeLog2) - 1) {
+
+	clear();
+}
+
+bool TranspositionTable::find(std::uint64_t key, float& value, Counters& counters) const {
+	const Entry& entry = entries_[key & mask_];
+	std::uint64_t data = entry.data_.load(std::memory_order_relaxed);
+	std::uint64_t check = entry.check_.load(std::memory_order_relaxed);
+	if ((data & USED_BIT) && (check ^ data) == key) {
+		value = toValue(data);
+		++counters.hits_;
+		return true;
+	}
+	++counters.misses_;
+	return false;
+}
+
+void TranspositionTable::insert(std::uint64_t key, float value) {
+	Entry& entry = entries_[key & mask_];
+	std::uint64_t data = toData(value);
+	entry.check_.store(key ^ data, std::memory_order_relaxed);
+	entry.data_.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+	for (Entry& entry : entries_) {
+		entry.check_ = 0;
+		entry.data_ = 0;
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// A fixed size hash table with the values of already searched positions. The
+// table is safe to use from several threads without locks, each entry saves the
+// key xor the data, i.e. an entry written by two threads at once is not found.
+// A new value always replaces the old value in the same slot.
+class TranspositionTable {
+public:
+	// Create a table with 2^sizeLog2 entries.
+	explicit TranspositionTable(int sizeLog2);
+
+	TranspositionTable(const TranspositionTable&) = delete;
+	TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+	// The lookups found and not found. Counted by the caller, e.g. one for each
+	// thread, a counter shared by all threads would move between the cores on every
+	// lookup.
+	struct Counters {
+		Counters() : hits_(0), misses_(0) {
+		}
+
+		Counters& operator+=(const Counters& counters) {
+			hits_ += counters.hits_;
+			misses_ += counters.misses_;
+			return *this;
+		}
+
+		std::uint64_t hits_;
+		std::uint64_t misses_;
+	};
+
+	// Return true and set the value if the key is found. The lookup is counted.
+	bool find(std::uint64_t key, float& value, Counters& counters) const;
+
+	void insert(std::uint64_t key, float value);
+
+	// Remove all entries.
+	void clear();
+
+	int getSize() const {
+		return entries_.size();
+	}
+
+private:
+	struct Entry {
+		std::atomic<std::uint64_t> check_;
+		std::atomic<std::uint64_t> data_;
+	};
+
+	std::vector<Entry> entries_;
+	std::uint64_t mask_;
+};
+
+#endif // TRANSPOSITIONTABLE_H
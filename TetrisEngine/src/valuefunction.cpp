@@ -0,0 +1,158 @@
+#include "valuefunction.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+	int getPrecedence(char op) {
+		switch (op) {
+			case '+':
+			case '-':
+				return 1;
+			case '*':
+			case '/':
+				return 2;
+			case '~': // Unary minus.
+				return 3;
+		}
+		return 0;
+	}
+
+} // Anonymous namespace.
+
+ValueFunction::ValueFunction() {
+}
+
+bool ValueFunction::compile(const std::string& expression, const std::vector<std::string>& variables) {
+	instructions_.clear();
+	std::vector<char> operators;
+	bool expectOperand = true;
+	int stackSize = 0;
+	bool valid = true;
+
+	auto addOperator = [&](char op) {
+		Instruction instruction{OpCode::NEGATE, 0, 0};
+		switch (op) {
+			case '+': instruction.code_ = OpCode::ADD; break;
+			case '-': instruction.code_ = OpCode::SUBTRACT; break;
+			case '*': instruction.code_ = OpCode::MULTIPLY; break;
+			case '/': instruction.code_ = OpCode::DIVIDE; break;
+		}
+		if (op == '~') {
+			valid = valid && stackSize >= 1;
+		} else {
+			valid = valid && stackSize >= 2;
+			--stackSize;
+		}
+		instructions_.push_back(instruction);
+	};
+
+	std::string::size_type i = 0;
+	while (valid && i < expression.size()) {
+		const char c = expression[i];
+		if (std::isspace((unsigned char) c)) {
+			++i;
+		} else if (std::isdigit((unsigned char) c) || c == '.') {
+			std::string::size_type end = i;
+			while (end < expression.size() && (std::isdigit((unsigned char) expression[end]) || expression[end] == '.')) {
+				++end;
+			}
+			float value = std::strtof(expression.substr(i, end - i).c_str(), nullptr);
+			instructions_.push_back(Instruction{OpCode::NUMBER, 0, value});
+			valid = expectOperand;
+			expectOperand = false;
+			++stackSize;
+			i = end;
+		} else if (std::isalpha((unsigned char) c) || c == '_') {
+			std::string::size_type end = i;
+			while (end < expression.size() && (std::isalnum((unsigned char) expression[end]) || expression[end] == '_')) {
+				++end;
+			}
+			auto it = std::find(variables.begin(), variables.end(), expression.substr(i, end - i));
+			instructions_.push_back(Instruction{OpCode::VARIABLE, (int) (it - variables.begin()), 0});
+			// Unknown variables and functions are not supported.
+			valid = expectOperand && it != variables.end();
+			expectOperand = false;
+			++stackSize;
+			i = end;
+		} else if (c == '(') {
+			operators.push_back(c);
+			valid = expectOperand;
+			++i;
+		} else if (c == ')') {
+			while (!operators.empty() && operators.back() != '(') {
+				addOperator(operators.back());
+				operators.pop_back();
+			}
+			valid = valid && !expectOperand && !operators.empty();
+			if (valid) {
+				operators.pop_back();
+			}
+			++i;
+		} else if (c == '-' && expectOperand) {
+			operators.push_back('~');
+			++i;
+		} else if (getPrecedence(c) > 0 && c != '~' && !expectOperand) {
+			// All binary operators are left associative.
+			while (!operators.empty() && operators.back() != '(' && getPrecedence(operators.back()) >= getPrecedence(c)) {
+				addOperator(operators.back());
+				operators.pop_back();
+			}
+			operators.push_back(c);
+			expectOperand = true;
+			++i;
+		} else {
+			valid = false;
+		}
+		valid = valid && stackSize <= MAX_STACK_SIZE;
+	}
+
+	while (valid && !operators.empty()) {
+		valid = operators.back() != '(';
+		addOperator(operators.back());
+		operators.pop_back();
+	}
+
+	if (!valid || expectOperand || stackSize != 1) {
+		instructions_.clear();
+		return false;
+	}
+	return true;
+}
+
+float ValueFunction::calculate(const float* variables) const {
+	float stack[MAX_STACK_SIZE];
+	int size = 0;
+	for (const Instruction& instruction : instructions_) {
+		switch (instruction.code_) {
+			case OpCode::NUMBER:
+				stack[size++] = instruction.value_;
+				break;
+			case OpCode::VARIABLE:
+				stack[size++] = variables[instruction.index_];
+				break;
+			case OpCode::NEGATE:
+				stack[size - 1] = -stack[size - 1];
+				break;
+			case OpCode::ADD:
+				--size;
+				stack[size - 1] += stack[size];
+				break;
+			case OpCode::SUBTRACT:
+				--size;
+				stack[size - 1] -= stack[size];
+				break;
+			case OpCode::MULTIPLY:
+				--size;
+				stack[size - 1] *= stack[size];
+				break;
+			case OpCode::DIVIDE:
+				--size;
+				stack[size - 1] /= stack[size];
+				break;
+		}
+	}
+	return stack[0];
+}
@@ -0,0 +1,49 @@
+#ifndef VALUEFUNCTION_H
+#define VALUEFUNCTION_H
+
+#include <string>
+#include <vector>
+
+// An arithmetic expression compiled to a flat list of stack instructions. The
+// variables are read by index from an array, i.e. no lookups by name when calculating.
+// Supported are numbers, variables, + - * /, unary minus and parentheses. Other
+// expressions (e.g. functions and powers) are not compiled and the function is then invalid.
+class ValueFunction {
+public:
+	static const int MAX_STACK_SIZE = 32;
+
+	ValueFunction();
+
+	// Compile the expression. The variable at index i in variables is read from
+	// index i in the array given to calculate. Return true if the expression is
+	// supported, else the function becomes invalid.
+	bool compile(const std::string& expression, const std::vector<std::string>& variables);
+
+	bool isValid() const {
+		return !instructions_.empty();
+	}
+
+	// Return the value of the expression. The function must be valid.
+	float calculate(const float* variables) const;
+
+private:
+	enum class OpCode : char {
+		NUMBER,
+		VARIABLE,
+		NEGATE,
+		ADD,
+		SUBTRACT,
+		MULTIPLY,
+		DIVIDE
+	};
+
+	struct Instruction {
+		OpCode code_;
+		int index_;
+		float value_;
+	};
+
+	std::vector<Instruction> instructions_;
+};
+
+#endif // VALUEFUNCTION_H
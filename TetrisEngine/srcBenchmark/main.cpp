@@ -0,0 +1,367 @@
+#include <ai.h>
+#include <blockgenerator.h>
+#include <boardcorpus.h>
+#include <rawtetrisboard.h>
+#include <tetrisboard.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+	const int ROWS = 24;
+	const int COLUMNS = 10;
+
+	// Keeps the results alive, i.e. the compiler can not remove the benchmarked code.
+	volatile std::uint64_t sink = 0;
+
+	struct Result {
+		std::string name_;
+		long long operations_;
+		double nanoseconds_; // Per operation.
+		TranspositionTable::Counters tableCounters_; // All samples, if the table is used.
+	};
+
+	// Call the function, doing a number of operations each call, until the time has
+	// passed. The fastest of the samples is used, it is the least disturbed one.
+	Result measure(const std::string& name, double seconds, const std::function<int()>& function) {
+		const int SAMPLES = 5;
+		using Clock = std::chrono::steady_clock;
+		double best = -1;
+		long long total = 0;
+		for (int sample = 0; sample < SAMPLES; ++sample) {
+			long long operations = 0;
+			const auto start = Clock::now();
+			std::chrono::duration<double> delta(0);
+			while (delta.count() < seconds / SAMPLES) {
+				operations += function();
+				delta = Clock::now() - start;
+			}
+			const double nanoseconds = delta.count() * 1e9 / operations;
+			best = best < 0 ? nanoseconds : std::min(best, nanoseconds);
+			total += operations;
+		}
+		return Result{name, total, best};
+	}
+
+	// Boards from seeded games, played by the default ai and by random placements,
+	// i.e. both low and high boards. The same boards every run.
+	std::vector<RawTetrisBoard> createCorpus() {
+		std::vector<RawTetrisBoard> corpus;
+		Ai ai;
+		std::vector<Ai::State> states;
+		for (std::uint64_t seed = 1; seed <= 4; ++seed) {
+			const bool random = seed % 2 == 0;
+			BlockGenerator blockGenerator(seed);
+			BlockType current = blockGenerator.generateBlockType();
+			TetrisBoard board(ROWS, COLUMNS, current, blockGenerator.generateBlockType());
+			board.addGameEventListener([&](GameEvent gameEvent, const TetrisBoard&) {
+				if (gameEvent == GameEvent::BLOCK_COLLISION) {
+					board.updateNextBlock(blockGenerator.generateBlockType());
+				}
+			});
+			for (int turn = 0; turn < 400 && !board.isGameOver(); ++turn) {
+				if (turn % 10 == 0) {
+					corpus.push_back(board);
+				}
+				Ai::State state;
+				if (random) {
+					Ai::calculateAllPossibleStates(board.getBitBoard(), board.getBlock(), states);
+					if (states.empty()) {
+						break;
+					}
+					state = states[blockGenerator.generateInt(0, (int) states.size() - 1)];
+				} else {
+					state = ai.calculateBestState(board, 1);
+				}
+				board.placeBlock(state.rotationLeft_, board.getBlock().getStartColumn() - state.left_);
+			}
+		}
+		return corpus;
+	}
+
+	// Return false if the file is not a corpus file with boards of the benchmarked size.
+	bool readCorpus(const std::string& file, std::vector<RawTetrisBoard>& corpus) {
+		BoardCorpusReader reader;
+		if (!reader.open(file) || reader.getRows() != ROWS || reader.getColumns() != COLUMNS) {
+			return false;
+		}
+		corpus.clear();
+		for (std::size_t i = 0; i < reader.getSize(); ++i) {
+			corpus.push_back(reader.createBoard(i));
+		}
+		return true;
+	}
+
+	bool writeCorpus(const std::string& file, const std::vector<RawTetrisBoard>& corpus) {
+		BoardCorpusWriter writer;
+		if (!writer.open(file, ROWS, COLUMNS)) {
+			return false;
+		}
+		for (const RawTetrisBoard& board : corpus) {
+			writer.write(board);
+		}
+		return true;
+	}
+
+	// All rows filled except the last column, an I block falling into the hole removes four rows.
+	RawTetrisBoard createFourRowBoard() {
+		std::vector<BlockType> squares((ROWS + 4) * COLUMNS, BlockType::EMPTY);
+		for (int row = 0; row < 4; ++row) {
+			for (int column = 0; column < COLUMNS - 1; ++column) {
+				squares[row * COLUMNS + column] = BlockType::Z;
+			}
+		}
+		// Vertical, in the last column.
+		Block block = RawTetrisBoard::createStartBlock(BlockType::I, ROWS, COLUMNS);
+		while (block[0].column_ != block[1].column_) {
+			block.rotateLeft();
+		}
+		while (block[0].column_ < COLUMNS - 1) {
+			block.moveRight();
+		}
+		return RawTetrisBoard(squares, ROWS, COLUMNS, block, BlockType::I);
+	}
+
+	std::vector<Result> runBenchmarks(double seconds, const std::vector<RawTetrisBoard>& corpus) {
+		std::vector<Result> results;
+
+		std::vector<Block> blocks;
+		for (int type = 0; type < 7; ++type) {
+			blocks.push_back(RawTetrisBoard::createStartBlock((BlockType) type, ROWS, COLUMNS));
+		}
+		results.push_back(measure("block_rotate", seconds, [&]() {
+			for (Block& block : blocks) {
+				block.rotateLeft();
+				sink += block[0].column_;
+			}
+			return (int) blocks.size();
+		}));
+
+		// All rotations in all columns at all heights.
+		std::vector<Block> positions;
+		for (int type = 0; type < 7; ++type) {
+			for (int rotation = 0; rotation < 4; ++rotation) {
+				for (int column = 0; column < COLUMNS; ++column) {
+					for (int row = 0; row < ROWS; row += 3) {
+						positions.push_back(Block((BlockType) type, row, column, rotation));
+					}
+				}
+			}
+		}
+		results.push_back(measure("board_collision", seconds, [&]() {
+			for (const RawTetrisBoard& board : corpus) {
+				for (const Block& block : positions) {
+					sink += board.collision(block);
+				}
+			}
+			return (int) (corpus.size() * positions.size());
+		}));
+
+		results.push_back(measure("board_copy", seconds, [&]() {
+			for (const RawTetrisBoard& board : corpus) {
+				RawTetrisBoard copy = board;
+				sink += copy.getRows();
+			}
+			return (int) corpus.size();
+		}));
+
+		// Includes the board copy.
+		results.push_back(measure("board_down_ground", seconds, [&]() {
+			for (const RawTetrisBoard& board : corpus) {
+				RawTetrisBoard copy = board;
+				copy.update(Move::DOWN_GROUND);
+				copy.update(Move::DOWN_GRAVITY);
+				sink += copy.getBitBoard().getHash();
+			}
+			return (int) corpus.size();
+		}));
+
+		// Includes the board copy.
+		const RawTetrisBoard fourRowBoard = createFourRowBoard();
+		results.push_back(measure("board_remove_filled_rows", seconds, [&]() {
+			RawTetrisBoard copy = fourRowBoard;
+			copy.update(Move::DOWN_GROUND);
+			copy.update(Move::DOWN_GRAVITY);
+			sink += copy.getRemovedRows();
+			return 1;
+		}));
+
+		std::vector<Ai::State> states;
+		results.push_back(measure("ai_possible_states", seconds, [&]() {
+			for (const RawTetrisBoard& board : corpus) {
+				Ai::calculateAllPossibleStates(board.getBitBoard(), board.getBlock(), states);
+				sink += states.size();
+			}
+			return (int) corpus.size();
+		}));
+
+		Ai ai;
+		for (int depth = 1; depth <= 2; ++depth) {
+			results.push_back(measure("ai_best_state_depth_" + std::to_string(depth), seconds, [&]() {
+				for (const RawTetrisBoard& board : corpus) {
+					sink += ai.calculateBestState(board, depth).left_;
+				}
+				return (int) corpus.size();
+			}));
+		}
+
+		// The transposition table keeps the searched positions between the searches.
+		ThreadPool serialPool(0);
+		Ai::Workspace workspace = ai.createWorkspace(serialPool);
+		results.push_back(measure("ai_best_state_depth_2_table", seconds, [&]() {
+			for (const RawTetrisBoard& board : corpus) {
+				sink += ai.calculateBestState(board.getBitBoard(), board.getBlock(), board.getNextBlockType(), board.getRows(), 2,
+					serialPool, workspace).left_;
+			}
+			return (int) corpus.size();
+		}));
+		results.back().tableCounters_ = workspace.getTableCounters();
+		return results;
+	}
+
+	void printCsv(std::ostream& out, const std::vector<Result>& results) {
+		out << "benchmark,operations,nsPerOperation\n";
+		out << std::fixed << std::setprecision(2);
+		for (const Result& result : results) {
+			out << result.name_ << "," << result.operations_ << "," << result.nanoseconds_ << "\n";
+		}
+	}
+
+	// Not saved in the csv file, i.e. not a part of the baseline.
+	void printTableCounters(std::ostream& out, const std::vector<Result>& results) {
+		out << "\nbenchmark,tableHits,tableMisses,tableHitRate\n";
+		for (const Result& result : results) {
+			const std::uint64_t lookups = result.tableCounters_.hits_ + result.tableCounters_.misses_;
+			if (lookups > 0) {
+				out << result.name_ << "," << result.tableCounters_.hits_ << "," << result.tableCounters_.misses_ << ","
+					<< (double) result.tableCounters_.hits_ / lookups << "\n";
+			}
+		}
+	}
+
+	// Return the time per operation for each benchmark in a csv file printed before.
+	std::map<std::string, double> readCsv(const std::string& file) {
+		std::map<std::string, double> baseline;
+		std::ifstream infile(file);
+		std::string line;
+		std::getline(infile, line); // Header.
+		while (std::getline(infile, line)) {
+			std::stringstream stream(line);
+			std::string name, operations, nanoseconds;
+			if (std::getline(stream, name, ',') && std::getline(stream, operations, ',') && std::getline(stream, nanoseconds)) {
+				baseline[name] = std::atof(nanoseconds.c_str());
+			}
+		}
+		return baseline;
+	}
+
+	// Return the number of benchmarks slower than the baseline plus the tolerance.
+	int compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double tolerance) {
+		int regressions = 0;
+		std::cout << "\nbenchmark,baseline,current,ratio\n";
+		for (const Result& result : results) {
+			auto it = baseline.find(result.name_);
+			if (it == baseline.end() || it->second <= 0) {
+				continue;
+			}
+			const double ratio = result.nanoseconds_ / it->second;
+			const bool regression = ratio > 1 + tolerance;
+			regressions += regression;
+			std::cout << result.name_ << "," << it->second << "," << result.nanoseconds_ << "," << ratio
+				<< (regression ? ",REGRESSION" : "") << "\n";
+		}
+		return regressions;
+	}
+
+	void printHelpFunction(const std::string& programName) {
+		std::cout << "Usage: " << programName << "\n";
+		std::cout << "\t" << "Benchmark the hot paths in the tetris engine on a fixed set of boards.\n";
+		std::cout << "\t" << "The time per operation is printed as csv.\n\n";
+
+		std::cout << "Options: " << "\n";
+		std::cout << "\t-h --help                show this help\n";
+		std::cout << "\t-t --time                seconds to run each benchmark\n";
+		std::cout << "\t-o --output              save the result as a csv file\n";
+		std::cout << "\t-b --baseline            compare with a saved csv file, exit with 1 if slower\n";
+		std::cout << "\t-r --tolerance           allowed slowdown compared to the baseline, e.g. 0.1 for 10%\n";
+		std::cout << "\t-c --corpus              use the boards in a corpus file, " << ROWS << "x" << COLUMNS << ", instead of the generated boards\n";
+		std::cout << "\t-w --write-corpus        save the used boards as a corpus file\n";
+		std::exit(0);
+	}
+
+} // Anonymous namespace.
+
+int main(const int argc, const char* const argv[]) {
+	std::string programName = argc > 0 ? argv[0] : "";
+	double seconds = 1;
+	double tolerance = 0.1;
+	std::string output;
+	std::string baselineFile;
+	std::string corpusFile;
+	std::string writeCorpusFile;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help") {
+			printHelpFunction(programName);
+		} else if (i + 1 >= argc) {
+			std::cerr << "Missing argument after " << arg << " flag\n";
+			std::exit(1);
+		} else if (arg == "-t" || arg == "--time") {
+			seconds = std::atof(argv[++i]);
+		} else if (arg == "-o" || arg == "--output") {
+			output = argv[++i];
+		} else if (arg == "-b" || arg == "--baseline") {
+			baselineFile = argv[++i];
+		} else if (arg == "-r" || arg == "--tolerance") {
+			tolerance = std::atof(argv[++i]);
+		} else if (arg == "-c" || arg == "--corpus") {
+			corpusFile = argv[++i];
+		} else if (arg == "-w" || arg == "--write-corpus") {
+			writeCorpusFile = argv[++i];
+		} else {
+			std::cerr << "Unknown flag " << arg << "\n";
+			std::exit(1);
+		}
+	}
+
+	std::vector<RawTetrisBoard> corpus;
+	if (corpusFile.empty()) {
+		corpus = createCorpus();
+	} else if (!readCorpus(corpusFile, corpus) || corpus.empty()) {
+		std::cerr << "No " << ROWS << "x" << COLUMNS << " boards in " << corpusFile << "\n";
+		return 1;
+	}
+	if (!writeCorpusFile.empty() && !writeCorpus(writeCorpusFile, corpus)) {
+		std::cerr << "Failed to write " << writeCorpusFile << "\n";
+		return 1;
+	}
+
+	const std::vector<Result> results = runBenchmarks(seconds, corpus);
+	printCsv(std::cout, results);
+	printTableCounters(std::cout, results);
+	if (!output.empty()) {
+		std::ofstream outfile(output);
+		printCsv(outfile, results);
+	}
+	if (!baselineFile.empty()) {
+		std::map<std::string, double> baseline = readCsv(baselineFile);
+		if (baseline.empty()) {
+			std::cerr << "No baseline in " << baselineFile << "\n";
+			return 1;
+		}
+		return compare(results, baseline, tolerance) > 0 ? 1 : 0;
+	}
+	return 0;
+}
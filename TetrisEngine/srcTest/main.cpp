@@ -1,4 +1,8 @@
 #include <ai.h>
+#include <bitboard.h>
+#include <featurekernels.h>
+#include <replay.h>
+#include <simulation.h>
 #include <tetrisboard.h>
 
 #include <fstream>
@@ -10,6 +14,9 @@
 #include <thread>
 #include <chrono>
 #include <iomanip>
+#include <memory>
+#include <vector>
+#include <random>
 
 using namespace std::chrono_literals;
 
@@ -81,6 +88,171 @@ BlockType readBlockType(std::ifstream& infile) {
 	return badRandomBlockType();
 }
 
+std::vector<BlockType> readBlockTypes(const std::string& file) {
+	std::ifstream infile(file);
+	std::vector<BlockType> blockTypes;
+	int data;
+	while (infile >> data) {
+		if (data >= 0 && data <= 6) {
+			blockTypes.push_back((BlockType) data);
+		}
+	}
+	return blockTypes;
+}
+
+void printCsv(const std::vector<Simulation::Game>& games, const std::vector<Simulation::GameResult>& results, const Simulation::Summary& summary) {
+	std::cout << "game,seed,turns,cleared1,cleared2,cleared3,cleared4,seconds\n";
+	for (unsigned int i = 0; i < results.size(); ++i) {
+		const Simulation::GameResult& result = results[i];
+		std::cout << i << "," << games[i].seed_ << "," << result.turns_;
+		for (int rows : result.removedRows_) {
+			std::cout << "," << rows;
+		}
+		std::cout << "," << result.seconds_ << "\n";
+	}
+	std::cout << "\n";
+	std::cout << "games,turns,meanTurns,minTurns,maxTurns,cleared1,cleared2,cleared3,cleared4,seconds,gamesPerSecond,placementsPerSecond,"
+		<< "tableHits,tableMisses,tableHitRate\n";
+	std::cout << summary.games_ << "," << summary.turns_ << "," << summary.getMeanTurns() << ","
+		<< summary.minTurns_ << "," << summary.maxTurns_;
+	for (long long rows : summary.removedRows_) {
+		std::cout << "," << rows;
+	}
+	std::cout << "," << summary.seconds_ << "," << summary.getGamesPerSecond() << "," << summary.getPlacementsPerSecond()
+		<< "," << summary.tableCounters_.hits_ << "," << summary.tableCounters_.misses_ << "," << summary.getTableHitRate() << "\n";
+}
+
+void printJson(const std::vector<Simulation::Game>& games, const std::vector<Simulation::GameResult>& results, const Simulation::Summary& summary) {
+	std::cout << "{\n\t\"games\": [";
+	for (unsigned int i = 0; i < results.size(); ++i) {
+		const Simulation::GameResult& result = results[i];
+		std::cout << (i == 0 ? "\n" : ",\n");
+		std::cout << "\t\t{\"game\": " << i << ", \"seed\": " << games[i].seed_ << ", \"turns\": " << result.turns_
+			<< ", \"cleared\": [" << result.removedRows_[0] << ", " << result.removedRows_[1] << ", "
+			<< result.removedRows_[2] << ", " << result.removedRows_[3] << "], \"seconds\": " << result.seconds_ << "}";
+	}
+	std::cout << "\n\t],\n";
+	std::cout << "\t\"summary\": {\"games\": " << summary.games_ << ", \"turns\": " << summary.turns_
+		<< ", \"meanTurns\": " << summary.getMeanTurns() << ", \"minTurns\": " << summary.minTurns_
+		<< ", \"maxTurns\": " << summary.maxTurns_ << ", \"cleared\": [" << summary.removedRows_[0] << ", "
+		<< summary.removedRows_[1] << ", " << summary.removedRows_[2] << ", " << summary.removedRows_[3]
+		<< "], \"seconds\": " << summary.seconds_ << ", \"gamesPerSecond\": " << summary.getGamesPerSecond()
+		<< ", \"placementsPerSecond\": " << summary.getPlacementsPerSecond() << ", \"tableHits\": " << summary.tableCounters_.hits_
+		<< ", \"tableMisses\": " << summary.tableCounters_.misses_ << ", \"tableHitRate\": " << summary.getTableHitRate() << "}\n}\n";
+}
+
+// Run the games in parallel and print the results in game order.
+void runBatch(const Ai& ai, int games, unsigned int seed, BlockGenerator::Mode mode, const std::vector<std::string>& files, int threads,
+	int width, int height, int maxNbrBlocks, bool json) {
+
+	std::vector<std::shared_ptr<const std::vector<BlockType>>> blockTypes;
+	for (const std::string& file : files) {
+		blockTypes.push_back(std::make_shared<const std::vector<BlockType>>(readBlockTypes(file)));
+		if (blockTypes.back()->empty()) {
+			std::cerr << "No block types in file " << file << "\n";
+			std::exit(1);
+		}
+	}
+
+	std::vector<Simulation::Game> gameSetups;
+	for (int i = 0; i < games; ++i) {
+		Simulation::Game game{seed + i, nullptr, mode};
+		if (!blockTypes.empty()) {
+			game.blockTypes_ = blockTypes[i % blockTypes.size()];
+		}
+		gameSetups.push_back(game);
+	}
+
+	Simulation simulation(height, width, maxNbrBlocks, 1);
+	ThreadPool threadPool(threads);
+	auto time = std::chrono::steady_clock::now();
+	std::vector<Simulation::GameResult> results = simulation.run(ai, gameSetups, threadPool);
+	std::chrono::duration<double> delta = std::chrono::steady_clock::now() - time;
+	Simulation::Summary summary = Simulation::summarize(results, delta.count());
+
+	std::cout << std::setprecision(6);
+	if (json) {
+		printJson(gameSetups, results, summary);
+	} else {
+		printCsv(gameSetups, results, summary);
+	}
+}
+
+// Play the recorded games again and print the result for each player as csv.
+void runReplay(const std::string& file) {
+	std::vector<Replay::Game> games;
+	if (!Replay::read(file, games)) {
+		std::cerr << "Not a replay file " << file << "\n";
+		std::exit(1);
+	}
+
+	std::cout << "game,player,seed,ticks,turns,cleared,gameOver\n";
+	double gameSeconds = 0;
+	auto time = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < games.size(); ++i) {
+		ReplayPlayer replayPlayer(games[i]);
+		replayPlayer.runToEnd();
+		gameSeconds += games[i].getSeconds();
+		for (int player = 0; player < replayPlayer.getNbrOfPlayers(); ++player) {
+			const TetrisBoard& board = replayPlayer.getTetrisBoard(player);
+			std::cout << i << "," << player << "," << games[i].seeds_[player] << "," << replayPlayer.getTick() << ","
+				<< board.getTurns() << "," << board.getRemovedRows() << "," << board.isGameOver() << "\n";
+		}
+	}
+	std::chrono::duration<double> delta = std::chrono::steady_clock::now() - time;
+	std::cout << "\ngames,gameSeconds,seconds,speedup\n";
+	std::cout << games.size() << "," << gameSeconds << "," << delta.count() << ","
+		<< (delta.count() > 0 ? gameSeconds / delta.count() : 0) << "\n";
+}
+
+// Compare the feature kernels with the scalar versions on random boards, for all sizes
+// up to the board size. Return the number of results not the same.
+int runKernelCheck(int boards, unsigned int seed) {
+	std::mt19937 random(seed);
+	int checks = 0;
+	int mismatches = 0;
+	auto check = [&](const char* kernel, int size, int result, int scalarResult) {
+		++checks;
+		if (result != scalarResult) {
+			++mismatches;
+			std::cerr << kernel << " size " << size << " is " << result << ", scalar " << scalarResult << "\n";
+		}
+	};
+
+	for (int i = 0; i < boards; ++i) {
+		const int rows = std::uniform_int_distribution<int>(1, BitBoard::MAX_ROWS)(random);
+		const int columns = std::uniform_int_distribution<int>(1, BitBoard::MAX_COLUMNS)(random);
+		std::bernoulli_distribution occupied(std::uniform_real_distribution<double>(0, 1)(random));
+		BitBoard board(rows, columns);
+		for (int row = 0; row < rows; ++row) {
+			for (int column = 0; column < columns; ++column) {
+				if (occupied(random)) {
+					board.set(row, column);
+				}
+			}
+		}
+		if (random() % 2 == 0) {
+			board.eraseRow(random() % rows);
+		}
+
+		const std::uint64_t mask = (std::uint64_t) random() << 32 | random();
+		for (int size = 0; size <= board.getHeight(); ++size) {
+			check("weightedBitCount", size, FeatureKernels::weightedBitCount(board.getRowData(), size, mask),
+				FeatureKernels::weightedBitCountScalar(board.getRowData(), size, mask));
+			check("weightedBitCount", size, FeatureKernels::weightedBitCount(board.getRowData(), size, ~std::uint64_t(0)),
+				FeatureKernels::weightedBitCountScalar(board.getRowData(), size, ~std::uint64_t(0)));
+		}
+		for (int size = 0; size <= columns; ++size) {
+			check("adjacentDifferenceSum", size, FeatureKernels::adjacentDifferenceSum(board.getColumnSquareData(), size),
+				FeatureKernels::adjacentDifferenceSumScalar(board.getColumnSquareData(), size));
+		}
+	}
+
+	std::cout << "simd,boards,checks,mismatches\n";
+	std::cout << FeatureKernels::isSimdEnabled() << "," << boards << "," << checks << "," << mismatches << "\n";
+	return mismatches;
+}
+
 void printHelpFunction(std::string programName, const Ai& ai) {
 	std::cout << "Usage: " << programName << "\n";
 	std::cout << "\t" << "Simulate a tetris game, using a ai value-funtion.\n";
@@ -89,7 +261,10 @@ void printHelpFunction(std::string programName, const Ai& ai) {
 	std::cout << "\t" << programName << " -a <VALUE_FUNCTION>\n";
 	std::cout << "\t" << programName << " -m <MAX_TURNS>\n";
 	std::cout << "\t" << programName << " -f <FILE>\n";
-	std::cout << "\t" << programName << " -s <WIDTH> <HEIGHT>\n\n";
+	std::cout << "\t" << programName << " -s <WIDTH> <HEIGHT>\n";
+	std::cout << "\t" << programName << " -b <GAMES> [-S <SEED>] [-j <THREADS>] [-f <FILE>]... [--json]\n";
+	std::cout << "\t" << programName << " -S <SEED> [--bag]\n";
+	std::cout << "\t" << programName << " -r <REPLAY_FILE>\n\n";
 
 	std::cout << "\t" << "Variables available in the value function:\n";
 	for (std::string var : ai.getCalculator().getVariables()) {
@@ -110,6 +285,10 @@ void printHelpFunction(std::string programName, const Ai& ai) {
 	std::cout << "\tExample of data in file is \"0 2 0 7 1 3\".\n";
 	std::cout << "\tWhen the simulation has used the whole file, it start to read from the beginning again, and so on.\n\n";
 
+	std::cout << "\tIf using the -b flag, the games are run in parallel and the result for each game and\n";
+	std::cout << "\tthe total is printed as csv (or json), always in game order. Game i uses the seed\n";
+	std::cout << "\tSEED + i, or if -f is used (may be repeated) file number i modulo the number of files.\n\n";
+
 	std::cout << "Options: " << "\n";
 	std::cout << "\t-h --help                show this help\n";
 	std::cout << "\t-d --delay               delay in milliseconds between each turn\n";
@@ -117,7 +296,15 @@ void printHelpFunction(std::string programName, const Ai& ai) {
 	std::cout << "\t-m --max-turns           define the max number of turns\n";
 	std::cout << "\t-f --file-data           use random data from a file\n";
 	std::cout << "\t-s --board-size          define the size of the board\n";
-	std::cout << "\t-p --play                show board each turn\n\n";
+	std::cout << "\t-p --play                show board each turn\n";
+	std::cout << "\t-b --batch              run a number of games in parallel\n";
+	std::cout << "\t-S --seed               the seed for the blocks, for the first game in a batch\n";
+	std::cout << "\t--bag                   generate the blocks in bags of all seven blocks\n";
+	std::cout << "\t-j --threads            the number of worker threads used in a batch\n";
+	std::cout << "\t--json                  print the batch result as json instead of csv\n";
+	std::cout << "\t-r --replay             play the games recorded in a replay file, as fast as possible\n";
+	std::cout << "\t-k --check-kernels      compare the SIMD feature kernels with the scalar versions on a number of\n";
+	std::cout << "\t                        random boards, the exit code is 1 if any result differs\n\n";
 	std::cout << "\tOutput order:\n";
 	std::cout << "\t-T --time                print the time lapsed\n";
 	std::cout << "\t-t --turns               print the number of turns\n";
@@ -163,6 +350,15 @@ int main(const int argc, const char* const argv[]) {
 	std::queue<std::string> outputOrder;
 	std::ifstream infile;
 
+	int batchGames = 0;
+	unsigned int seed = std::random_device{}();
+	int threads = ThreadPool::getDefaultNbrOfWorkers();
+	std::vector<std::string> files;
+	bool json = false;
+	BlockGenerator::Mode mode = BlockGenerator::Mode::UNIFORM;
+	std::string replayFile;
+	int kernelBoards = 0;
+
 	for (int i = 0; i < argc; ++i) {
 		std::string arg = argv[i];
 		if (arg == "-h" || arg == "--help") {
@@ -201,7 +397,10 @@ int main(const int argc, const char* const argv[]) {
 			}
 		} else if (arg == "-f" || arg == "--file-data") {
 			if (i + 1 < argc) {
-				infile.open(argv[i + 1]);
+				if (!infile.is_open()) {
+					infile.open(argv[i + 1]);
+				}
+				files.push_back(argv[i + 1]);
 				useRandomFile = true;
 				++i;
 			} else {
@@ -216,8 +415,8 @@ int main(const int argc, const char* const argv[]) {
 				stream >> width;
 				stream >> height;
 				i += 2;
-				if (width < 5 || width > 99) {
-					std::cerr << "Argument with flag " << arg << ", width " << width << " must be within [5, 99]\n";
+				if (width < 5 || width > BitBoard::MAX_COLUMNS) {
+					std::cerr << "Argument with flag " << arg << ", width " << width << " must be within [5, " << BitBoard::MAX_COLUMNS << "]\n";
 					std::exit(1);
 				}
 				if (height < 5 || height > 99) {
@@ -230,6 +429,54 @@ int main(const int argc, const char* const argv[]) {
 			}
 		} else if (arg == "-p" || arg == "--play") {
 			play = true;
+		} else if (arg == "-b" || arg == "--batch") {
+			if (i + 1 < argc) {
+				std::stringstream stream(argv[i + 1]);
+				stream >> batchGames;
+				++i;
+			} else {
+				std::cerr << "Missing argument after " << arg << " flag\n";
+				std::exit(1);
+			}
+		} else if (arg == "-S" || arg == "--seed") {
+			if (i + 1 < argc) {
+				std::stringstream stream(argv[i + 1]);
+				stream >> seed;
+				++i;
+			} else {
+				std::cerr << "Missing argument after " << arg << " flag\n";
+				std::exit(1);
+			}
+		} else if (arg == "-j" || arg == "--threads") {
+			if (i + 1 < argc) {
+				std::stringstream stream(argv[i + 1]);
+				stream >> threads;
+				++i;
+			} else {
+				std::cerr << "Missing argument after " << arg << " flag\n";
+				std::exit(1);
+			}
+		} else if (arg == "-r" || arg == "--replay") {
+			if (i + 1 < argc) {
+				replayFile = argv[i + 1];
+				++i;
+			} else {
+				std::cerr << "Missing argument after " << arg << " flag\n";
+				std::exit(1);
+			}
+		} else if (arg == "-k" || arg == "--check-kernels") {
+			if (i + 1 < argc) {
+				std::stringstream stream(argv[i + 1]);
+				stream >> kernelBoards;
+				++i;
+			} else {
+				std::cerr << "Missing argument after " << arg << " flag\n";
+				std::exit(1);
+			}
+		} else if (arg == "--json") {
+			json = true;
+		} else if (arg == "--bag") {
+			mode = BlockGenerator::Mode::BAG;
 		} else if (arg == "-T" || arg == "--time-output") {
 			outputOrder.push("-T");
 		} else if (arg == "-t" || arg == "--turn-output") {
@@ -245,8 +492,23 @@ int main(const int argc, const char* const argv[]) {
 		}
 	}
 
-	BlockType start = randomBlockType();
-	BlockType next = randomBlockType();
+	if (kernelBoards > 0) {
+		return runKernelCheck(kernelBoards, seed) == 0 ? 0 : 1;
+	}
+
+	if (!replayFile.empty()) {
+		runReplay(replayFile);
+		return 0;
+	}
+
+	if (batchGames > 0) {
+		runBatch(ai, batchGames, seed, mode, files, threads, width, height, maxNbrBlocks, json);
+		return 0;
+	}
+
+	BlockGenerator blockGenerator(seed, mode);
+	BlockType start = blockGenerator.generateBlockType();
+	BlockType next = blockGenerator.generateBlockType();
 	
 	if (useRandomFile) {
 		start = readBlockType(infile);
@@ -265,7 +527,7 @@ int main(const int argc, const char* const argv[]) {
 				BlockType blockType = readBlockType(infile);
 				tetrisBoard.updateNextBlock(blockType);
 			} else {
-				tetrisBoard.updateNextBlock(randomBlockType());
+				tetrisBoard.updateNextBlock(blockGenerator.generateBlockType());
 			}
 		}
 		switch (gameEvent) {
@@ -294,24 +556,8 @@ int main(const int argc, const char* const argv[]) {
 			printBoard(tetrisBoard);
 		}
 
-		// Rotate block.
-		for (int i = 0; i < state.rotationLeft_; ++i) {
-			tetrisBoard.update(Move::ROTATE_LEFT);
-		}
-
-		// Move side-ways.
-		while (state.left_ != 0) {
-			if (state.left_ < 0) {
-				tetrisBoard.update(Move::RIGHT);
-				++state.left_;
-			} else if (state.left_ > 0) {
-				tetrisBoard.update(Move::LEFT);
-				--state.left_;
-			}
-		}
-
-		tetrisBoard.update(Move::DOWN_GROUND);
-		tetrisBoard.update(Move::DOWN_GRAVITY);
+		// Rotate, move side-ways and down to the ground.
+		tetrisBoard.placeBlock(state.rotationLeft_, tetrisBoard.getBlock().getStartColumn() - state.left_);
 		if (delay > 1ms) {
 			std::this_thread::sleep_for(delay);
 		}
@@ -0,0 +1,98 @@
+#include "expressiontemplate.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+	bool isNameCharacter(char c) {
+		return std::isalnum((unsigned char) c) || c == '_';
+	}
+
+	bool isNumberCharacter(char c) {
+		return std::isdigit((unsigned char) c) || c == '.';
+	}
+
+	void removeTrailingSpaces(std::string& text) {
+		while (!text.empty() && std::isspace((unsigned char) text.back())) {
+			text.pop_back();
+		}
+	}
+
+	// Without exponent, the value function does not support it.
+	std::string toString(float value) {
+		std::ostringstream stream;
+		stream << std::fixed << std::setprecision(3) << value;
+		std::string text = stream.str();
+		text.erase(text.find_last_not_of('0') + 1);
+		if (text.back() == '.') {
+			text.pop_back();
+		}
+		return text == "-0" ? "0" : text;
+	}
+
+} // Anonymous namespace.
+
+ExpressionTemplate::ExpressionTemplate(const std::string& expression) {
+	std::string text;
+	std::string::size_type i = 0;
+	while (i < expression.size()) {
+		const bool numberStart = isNumberCharacter(expression[i]) && (text.empty() || !isNameCharacter(text.back()));
+		if (!numberStart) {
+			text += expression[i++];
+			continue;
+		}
+
+		std::string::size_type end = i;
+		while (end < expression.size() && isNumberCharacter(expression[end])) {
+			++end;
+		}
+		std::string::size_type next = end;
+		while (next < expression.size() && std::isspace((unsigned char) expression[next])) {
+			++next;
+		}
+		const std::string number = expression.substr(i, end - i);
+		i = end;
+		if (next >= expression.size() || expression[next] != '*') {
+			// Not a coefficient.
+			text += number;
+			continue;
+		}
+
+		float value = std::strtof(number.c_str(), nullptr);
+		bool binary = false;
+		std::string before = text;
+		removeTrailingSpaces(before);
+		if (!before.empty() && (before.back() == '-' || before.back() == '+')) {
+			const bool negative = before.back() == '-';
+			before.pop_back();
+			removeTrailingSpaces(before);
+			// A sign after an operand is a binary operator.
+			binary = !before.empty() && (isNameCharacter(before.back()) || before.back() == '.' || before.back() == ')');
+			value = negative ? -value : value;
+			text = before;
+		}
+		parts_.push_back(Part{text, binary});
+		coefficients_.push_back(value);
+		text.clear();
+	}
+	tail_ = text;
+}
+
+std::string ExpressionTemplate::createExpression(const std::vector<float>& coefficients) const {
+	std::string expression;
+	for (unsigned int i = 0; i < parts_.size(); ++i) {
+		expression += parts_[i].text_;
+		const float value = i < coefficients.size() ? coefficients[i] : coefficients_[i];
+		if (parts_[i].binary_) {
+			expression += value < 0 ? " - " : " + ";
+			expression += toString(std::abs(value));
+		} else {
+			expression += toString(value);
+		}
+	}
+	return expression + tail_;
+}
@@ -0,0 +1,35 @@
+#ifndef EXPRESSIONTEMPLATE_H
+#define EXPRESSIONTEMPLATE_H
+
+#include <string>
+#include <vector>
+
+// A value function where the coefficients are parameters, e.g. "-2*rowHoles - 5*columnHoles"
+// has the coefficients -2 and -5. Only numbers directly followed by '*' are
+// coefficients, other numbers are kept as they are.
+class ExpressionTemplate {
+public:
+	explicit ExpressionTemplate(const std::string& expression);
+
+	// The coefficients in the original expression.
+	const std::vector<float>& getCoefficients() const {
+		return coefficients_;
+	}
+
+	// Return the expression with the coefficients replaced, in the same order.
+	std::string createExpression(const std::vector<float>& coefficients) const;
+
+private:
+	// The text before a coefficient.
+	struct Part {
+		std::string text_;
+		// True if the coefficient is added or subtracted, i.e. the sign is written as a binary operator.
+		bool binary_;
+	};
+
+	std::vector<Part> parts_;
+	std::string tail_;
+	std::vector<float> coefficients_;
+};
+
+#endif // EXPRESSIONTEMPLATE_H
@@ -0,0 +1,148 @@
+#include "expressiontemplate.h"
+#include "tuner.h"
+
+#include <ai.h>
+#include <simulation.h>
+#include <threadpool.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+void printHelpFunction(std::string programName, const Ai& ai) {
+	std::cout << "Usage: " << programName << "\n";
+	std::cout << "\t" << "Tune the coefficients in an ai value function with a genetic algorithm.\n";
+	std::cout << "\t" << "Default ai value function is \"" << ai.getValueFunction() << "\".\n";
+	std::cout << "\t" << "Numbers directly followed by '*' are coefficients, other numbers are kept.\n\n";
+
+	std::cout << "\t" << "After each generation the population is saved to the checkpoint file, if the\n";
+	std::cout << "\t" << "file exists at start the tuning continues from it. The best value function is\n";
+	std::cout << "\t" << "printed in the same format as the ais in tetris.json.\n\n";
+
+	std::cout << "Options: " << "\n";
+	std::cout << "\t-h --help                show this help\n";
+	std::cout << "\t-a --ai-function         the value function to tune\n";
+	std::cout << "\t-g --generations         the number of generations\n";
+	std::cout << "\t-p --population          the number of individuals in each generation\n";
+	std::cout << "\t-n --games               the number of games for each individual\n";
+	std::cout << "\t-m --max-turns           the max number of turns in each game\n";
+	std::cout << "\t-s --sigma               the relative standard deviation of the mutations\n";
+	std::cout << "\t-S --seed                the seed for the games and the algorithm\n";
+	std::cout << "\t-j --threads             the number of worker threads\n";
+	std::cout << "\t-c --checkpoint          the checkpoint file\n\n";
+
+	std::cout << "Example: " << "\n";
+	std::cout << "\t" << programName << " -a \"-2*rowHoles - 5*columnHoles\" -g 50 -n 16\n";
+	std::exit(0);
+}
+
+template <class Value>
+void readArgument(const int argc, const char* const argv[], int& i, Value& value) {
+	if (i + 1 < argc) {
+		std::stringstream stream(argv[i + 1]);
+		stream >> value;
+		++i;
+	} else {
+		std::cerr << "Missing argument after " << argv[i] << " flag\n";
+		std::exit(1);
+	}
+}
+
+int main(const int argc, const char* const argv[]) {
+	std::string programName;
+	if (argc > 0) {
+		programName = argv[0];
+	}
+
+	Ai ai;
+	int generations = 20;
+	int populationSize = 24;
+	int games = 8;
+	int maxNbrBlocks = 1000;
+	float sigma = 0.3f;
+	unsigned int seed = std::random_device{}();
+	int threads = ThreadPool::getDefaultNbrOfWorkers();
+	std::string checkpoint = "tuner.checkpoint";
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help") {
+			printHelpFunction(programName, ai);
+		} else if (arg == "-a" || arg == "--ai-function") {
+			std::string valueFunction;
+			if (i + 1 < argc) {
+				valueFunction = argv[++i];
+			} else {
+				std::cerr << "Missing argument after " << arg << " flag\n";
+				std::exit(1);
+			}
+			ai = Ai("AI", valueFunction);
+			if (ai.getCalculator().hasError()) {
+				std::cerr << "Value function error: ";
+				std::cerr << ai.getCalculator().getErrorMessage() << "\n";
+				std::exit(1);
+			}
+		} else if (arg == "-g" || arg == "--generations") {
+			readArgument(argc, argv, i, generations);
+		} else if (arg == "-p" || arg == "--population") {
+			readArgument(argc, argv, i, populationSize);
+		} else if (arg == "-n" || arg == "--games") {
+			readArgument(argc, argv, i, games);
+		} else if (arg == "-m" || arg == "--max-turns") {
+			readArgument(argc, argv, i, maxNbrBlocks);
+		} else if (arg == "-s" || arg == "--sigma") {
+			readArgument(argc, argv, i, sigma);
+		} else if (arg == "-S" || arg == "--seed") {
+			readArgument(argc, argv, i, seed);
+		} else if (arg == "-j" || arg == "--threads") {
+			readArgument(argc, argv, i, threads);
+		} else if (arg == "-c" || arg == "--checkpoint") {
+			readArgument(argc, argv, i, checkpoint);
+		} else {
+			std::cerr << "Unknown flag " << arg << "\n";
+			std::exit(1);
+		}
+	}
+
+	ExpressionTemplate expressionTemplate(ai.getValueFunction());
+	if (expressionTemplate.getCoefficients().empty()) {
+		std::cerr << "No coefficients in the value function \"" << ai.getValueFunction() << "\"\n";
+		std::exit(1);
+	}
+
+	std::vector<Simulation::Game> gameSetups;
+	for (int i = 0; i < games; ++i) {
+		gameSetups.push_back(Simulation::Game{seed + i, nullptr});
+	}
+
+	// The same workers are used for all generations.
+	ThreadPool threadPool(threads);
+	Tuner tuner(expressionTemplate, Simulation(24, 10, maxNbrBlocks, 1), gameSetups, populationSize, sigma, seed);
+	if (tuner.load(checkpoint)) {
+		std::cerr << "Continue from generation " << tuner.getGeneration() << " in " << checkpoint << "\n";
+	} else {
+		tuner.initialize(threadPool);
+		tuner.save(checkpoint);
+	}
+
+	while (true) {
+		std::cerr << "Generation " << tuner.getGeneration() << "\tbest " << tuner.getBest().fitness_
+			<< "\tmean " << tuner.getMeanFitness() << "\t" << tuner.createExpression(tuner.getBest()) << "\n";
+		if (tuner.getGeneration() + 1 >= generations) {
+			break;
+		}
+		tuner.step(threadPool);
+		if (!tuner.save(checkpoint)) {
+			std::cerr << "Failed to save " << checkpoint << "\n";
+		}
+	}
+
+	std::cout << "{\n";
+	std::cout << "\t\"name\": \"Tuned\",\n";
+	std::cout << "\t\"valueFunction\": \"" << tuner.createExpression(tuner.getBest()) << "\"\n";
+	std::cout << "}\n";
+	return 0;
+}
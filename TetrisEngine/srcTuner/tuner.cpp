@@ -0,0 +1,161 @@
+#include "tuner.h"
+
+#include <ai.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+namespace {
+
+	float calculateFitness(const Simulation::GameResult* results, int games) {
+		long long rows = 0;
+		for (int i = 0; i < games; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				rows += (j + 1) * results[i].removedRows_[j];
+			}
+		}
+		return games > 0 ? (float) rows / games : 0;
+	}
+
+} // Anonymous namespace.
+
+const int Tuner::ELITES;
+const int Tuner::TOURNAMENT_SIZE;
+constexpr float Tuner::MUTATION_PROBABILITY;
+
+Tuner::Tuner(const ExpressionTemplate& expressionTemplate, const Simulation& simulation,
+	const std::vector<Simulation::Game>& games, int populationSize, float sigma, unsigned int seed) :
+	expressionTemplate_(expressionTemplate), simulation_(simulation), games_(games),
+	populationSize_(std::max(populationSize, ELITES + 1)), sigma_(sigma), seed_(seed), generation_(0) {
+}
+
+void Tuner::initialize(ThreadPool& threadPool) {
+	std::mt19937 random(seed_);
+	const std::vector<float>& coefficients = expressionTemplate_.getCoefficients();
+	population_.assign(1, Individual{coefficients, 0});
+	while ((int) population_.size() < populationSize_) {
+		Individual individual{coefficients, 0};
+		for (float& coefficient : individual.coefficients_) {
+			std::normal_distribution<float> noise(0, sigma_ * std::max(std::abs(coefficient), 1.f));
+			coefficient += noise(random);
+		}
+		population_.push_back(individual);
+	}
+	generation_ = 0;
+	evaluate(threadPool, 0);
+}
+
+void Tuner::step(ThreadPool& threadPool) {
+	// Deterministic for each generation, i.e. also after a load.
+	std::mt19937 random(seed_ + generation_ + 1);
+	std::uniform_real_distribution<float> uniform(0, 1);
+
+	std::vector<Individual> population(population_.begin(), population_.begin() + ELITES);
+	while ((int) population.size() < populationSize_) {
+		const Individual& first = selectParent(random);
+		const Individual& second = selectParent(random);
+		Individual child{first.coefficients_, 0};
+		for (unsigned int i = 0; i < child.coefficients_.size(); ++i) {
+			if (uniform(random) < 0.5f) {
+				child.coefficients_[i] = second.coefficients_[i];
+			}
+			if (uniform(random) < MUTATION_PROBABILITY) {
+				std::normal_distribution<float> noise(0, sigma_ * std::max(std::abs(child.coefficients_[i]), 1.f));
+				child.coefficients_[i] += noise(random);
+			}
+		}
+		population.push_back(child);
+	}
+	population_ = population;
+	++generation_;
+	// The elites play the same games again, no need to evaluate them.
+	evaluate(threadPool, ELITES);
+}
+
+float Tuner::getMeanFitness() const {
+	float sum = 0;
+	for (const Individual& individual : population_) {
+		sum += individual.fitness_;
+	}
+	return population_.empty() ? 0 : sum / population_.size();
+}
+
+std::string Tuner::createExpression(const Individual& individual) const {
+	return expressionTemplate_.createExpression(individual.coefficients_);
+}
+
+bool Tuner::save(const std::string& file) const {
+	std::ofstream outfile(file);
+	outfile << std::setprecision(9);
+	outfile << "generation " << generation_ << "\n";
+	outfile << "coefficients " << expressionTemplate_.getCoefficients().size() << "\n";
+	outfile << "population " << population_.size() << "\n";
+	for (const Individual& individual : population_) {
+		for (float coefficient : individual.coefficients_) {
+			outfile << coefficient << " ";
+		}
+		outfile << individual.fitness_ << "\n";
+	}
+	return outfile.good();
+}
+
+bool Tuner::load(const std::string& file) {
+	std::ifstream infile(file);
+	std::string label;
+	int generation = 0;
+	unsigned int coefficients = 0;
+	int size = 0;
+	infile >> label >> generation >> label >> coefficients >> label >> size;
+	if (!infile || coefficients != expressionTemplate_.getCoefficients().size() || size < ELITES) {
+		return false;
+	}
+	std::vector<Individual> population(size, Individual{std::vector<float>(coefficients), 0});
+	for (Individual& individual : population) {
+		for (float& coefficient : individual.coefficients_) {
+			infile >> coefficient;
+		}
+		infile >> individual.fitness_;
+	}
+	if (!infile) {
+		return false;
+	}
+	population_ = population;
+	generation_ = generation;
+	return true;
+}
+
+void Tuner::evaluate(ThreadPool& threadPool, int first) {
+	// Individuals with an invalid value function are not simulated.
+	std::vector<Ai> ais;
+	std::vector<int> indexes;
+	for (int i = first; i < (int) population_.size(); ++i) {
+		Ai ai("Tuned", createExpression(population_[i]));
+		if (ai.getCalculator().hasError()) {
+			population_[i].fitness_ = std::numeric_limits<float>::lowest();
+		} else {
+			ais.push_back(ai);
+			indexes.push_back(i);
+		}
+	}
+	std::vector<Simulation::GameResult> results = simulation_.run(ais, games_, threadPool);
+	for (unsigned int i = 0; i < indexes.size(); ++i) {
+		population_[indexes[i]].fitness_ = calculateFitness(results.data() + i * games_.size(), games_.size());
+	}
+	// Stable, i.e. the older of two equally good individuals is kept first.
+	std::stable_sort(population_.begin(), population_.end(), [](const Individual& a, const Individual& b) {
+		return a.fitness_ > b.fitness_;
+	});
+}
+
+const Tuner::Individual& Tuner::selectParent(std::mt19937& random) const {
+	std::uniform_int_distribution<int> distribution(0, population_.size() - 1);
+	// The population is sorted, the lowest index is the best.
+	int best = distribution(random);
+	for (int i = 1; i < TOURNAMENT_SIZE; ++i) {
+		best = std::min(best, distribution(random));
+	}
+	return population_[best];
+}
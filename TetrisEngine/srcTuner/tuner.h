@@ -0,0 +1,75 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include "expressiontemplate.h"
+
+#include <simulation.h>
+#include <threadpool.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+// A genetic algorithm searching for the coefficients in a value function giving
+// the most removed rows. All individuals in a generation play the same games, the
+// games for the whole population are run as one batch in the thread pool.
+class Tuner {
+public:
+	struct Individual {
+		std::vector<float> coefficients_;
+		// The mean number of removed rows per game.
+		float fitness_;
+	};
+
+	// The best individuals are kept unchanged in the next generation.
+	static const int ELITES = 2;
+	static const int TOURNAMENT_SIZE = 3;
+	static constexpr float MUTATION_PROBABILITY = 0.3f;
+
+	// The mutation adds noise with the standard deviation sigma * max(|coefficient|, 1).
+	Tuner(const ExpressionTemplate& expressionTemplate, const Simulation& simulation,
+		const std::vector<Simulation::Game>& games, int populationSize, float sigma, unsigned int seed);
+
+	// Create the first generation around the coefficients in the template and evaluate it.
+	void initialize(ThreadPool& threadPool);
+
+	// Create and evaluate the next generation.
+	void step(ThreadPool& threadPool);
+
+	int getGeneration() const {
+		return generation_;
+	}
+
+	// Return the best individual in the current generation.
+	const Individual& getBest() const {
+		return population_.front();
+	}
+
+	float getMeanFitness() const;
+
+	std::string createExpression(const Individual& individual) const;
+
+	// Save the current generation. Return false if the file could not be written.
+	bool save(const std::string& file) const;
+
+	// Load a generation saved with the same template. Return false if the file is
+	// missing or does not match, then nothing is changed.
+	bool load(const std::string& file);
+
+private:
+	// Evaluate all individuals without fitness and sort the population, best first.
+	void evaluate(ThreadPool& threadPool, int first);
+
+	const Individual& selectParent(std::mt19937& random) const;
+
+	ExpressionTemplate expressionTemplate_;
+	Simulation simulation_;
+	std::vector<Simulation::Game> games_;
+	std::vector<Individual> population_;
+	int populationSize_;
+	float sigma_;
+	unsigned int seed_;
+	int generation_;
+};
+
+#endif // TUNER_H
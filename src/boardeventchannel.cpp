@@ -0,0 +1,97 @@
+#include "boardeventchannel.h"
+#include "player.h"
+
+namespace {
+
+	void setBoardState(BoardEvent& event, GameEvent gameEvent, const TetrisBoard& tetrisBoard) {
+		const Block& block = tetrisBoard.getBlock();
+		event.event_ = gameEvent;
+		event.blockType_ = block.getBlockType();
+		event.lowestStartRow_ = block.getLowestStartRow();
+		event.startColumn_ = block.getStartColumn();
+		event.rotation_ = block.getCurrentRotation();
+		event.next_ = tetrisBoard.getNextBlockType();
+		event.rows_ = tetrisBoard.getRows();
+		event.columns_ = tetrisBoard.getColumns();
+		event.boardRows_ = tetrisBoard.getBoardVector().size() / tetrisBoard.getColumns();
+		event.removedRows_ = tetrisBoard.getRemovedRows();
+		event.rowToBeRemoved_ = tetrisBoard.getRowToBeRemoved();
+		event.externalRows_ = tetrisBoard.getNbrExternalRowsAdded();
+		event.row_ = -1;
+	}
+
+} // Anonymous namespace.
+
+BoardEventChannel::BoardEventChannel() : resync_(false), droppedEvents_(0) {
+}
+
+BoardEventChannel::~BoardEventChannel() {
+	connection_.disconnect();
+}
+
+void BoardEventChannel::connect(Player& player) {
+	connection_.disconnect();
+	BoardEvent event;
+	while (events_.pop(event)) {
+	}
+	resync_ = false;
+	connection_ = player.addGameEventListener(std::bind(&BoardEventChannel::push, this, std::placeholders::_1, std::placeholders::_2));
+}
+
+void BoardEventChannel::disconnect() {
+	connection_.disconnect();
+}
+
+bool BoardEventChannel::pop(BoardEvent& event) {
+	return events_.pop(event);
+}
+
+void BoardEventChannel::push(GameEvent gameEvent, const TetrisBoard& tetrisBoard) {
+	if (resync_ || gameEvent == GameEvent::RESTARTED) {
+		resync_ = !pushBoard(tetrisBoard);
+		if (resync_) {
+			++droppedEvents_;
+		}
+		// The board already holds the change, except for a row about to be removed.
+		if (resync_ || gameEvent != GameEvent::ROW_TO_BE_REMOVED) {
+			return;
+		}
+	}
+
+	BoardEvent event;
+	setBoardState(event, gameEvent, tetrisBoard);
+	if (gameEvent == GameEvent::EXTERNAL_ROWS_ADDED) {
+		if (events_.getFreeSpace() < event.externalRows_) {
+			resync_ = true;
+			++droppedEvents_;
+			return;
+		}
+		for (int row = event.externalRows_ - 1; row >= 0; --row) {
+			pushRow(event, tetrisBoard, row);
+			events_.push(event);
+		}
+	} else if (!events_.push(event)) {
+		resync_ = true;
+		++droppedEvents_;
+	}
+}
+
+bool BoardEventChannel::pushBoard(const TetrisBoard& tetrisBoard) {
+	BoardEvent event;
+	setBoardState(event, GameEvent::RESTARTED, tetrisBoard);
+	if (events_.getFreeSpace() <= event.boardRows_) { // Leave room for the event.
+		return false;
+	}
+	for (int row = 0; row < event.boardRows_; ++row) {
+		pushRow(event, tetrisBoard, row);
+		events_.push(event);
+	}
+	return true;
+}
+
+void BoardEventChannel::pushRow(BoardEvent& event, const TetrisBoard& tetrisBoard, int row) {
+	event.row_ = row;
+	for (int column = 0; column < event.columns_; ++column) {
+		event.squares_[column] = tetrisBoard.getBlockType(row, column);
+	}
+}
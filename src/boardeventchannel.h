@@ -0,0 +1,86 @@
+#ifndef BOARDEVENTCHANNEL_H
+#define BOARDEVENTCHANNEL_H
+
+#include "spscring.h"
+#include "tetrisboard.h"
+
+#include <mw/signal.h>
+
+#include <atomic>
+
+class Player;
+
+// A board event and the part of the board needed to draw it. A plain copy, i.e.
+// safe to read in another thread than the game.
+struct BoardEvent {
+	GameEvent event_;
+
+	// The current block, for GameEvent::BLOCK_COLLISION the block added to the board.
+	BlockType blockType_;
+	int lowestStartRow_;
+	int startColumn_;
+	int rotation_;
+
+	BlockType next_;
+	int rows_, columns_;
+	int boardRows_;     // Rows in the board vector, may be more than rows_.
+	int removedRows_;
+	int rowToBeRemoved_;
+	int externalRows_;
+
+	// The board row in squares_, -1 if not used. Set for each added row after
+	// GameEvent::EXTERNAL_ROWS_ADDED, from the highest to the lowest row, and for
+	// each board row after GameEvent::RESTARTED, from the lowest to the highest row.
+	int row_;
+	BlockType squares_[BitBoard::MAX_COLUMNS];
+
+	Block getBlock() const {
+		return Block(blockType_, lowestStartRow_, startColumn_, rotation_);
+	}
+};
+
+// Copies the board events of a player into a bounded lock-free queue, i.e. the game
+// only pays for the copy and the renderer takes the events at its own pace. If the
+// queue is full the events are dropped, and the whole board is sent again as a
+// GameEvent::RESTARTED with the next event there is room for.
+class BoardEventChannel {
+public:
+	// A few seconds of events, the renderer should take them every frame.
+	static const int CAPACITY = 256;
+
+	BoardEventChannel();
+	~BoardEventChannel();
+
+	BoardEventChannel(const BoardEventChannel&) = delete;
+	BoardEventChannel& operator=(const BoardEventChannel&) = delete;
+
+	// Receive the events of the player, events not yet taken are dropped. Must not be
+	// called while the board of the player is updated.
+	void connect(Player& player);
+
+	void disconnect();
+
+	// Move the oldest event to the argument, return false if empty. Only used by
+	// the reader.
+	bool pop(BoardEvent& event);
+
+	// The number of events dropped due to a full queue.
+	int getDroppedEvents() const {
+		return droppedEvents_;
+	}
+
+private:
+	void push(GameEvent gameEvent, const TetrisBoard& tetrisBoard);
+
+	// Push the whole board as GameEvent::RESTARTED, return false if not enough room.
+	bool pushBoard(const TetrisBoard& tetrisBoard);
+
+	void pushRow(BoardEvent& event, const TetrisBoard& tetrisBoard, int row);
+
+	SpscRing<BoardEvent, CAPACITY> events_;
+	mw::signals::Connection connection_;
+	bool resync_; // Only used by the writer.
+	std::atomic<int> droppedEvents_;
+};
+
+#endif // BOARDEVENTCHANNEL_H
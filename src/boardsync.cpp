@@ -0,0 +1,345 @@
+#include "boardsync.h"
+#include "localconnection.h"
+#include "remoteconnection.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+
+	// Seconds between the snapshots of a board.
+	const double SNAPSHOT_INTERVAL = 1.0;
+
+	// Snapshots kept to change from, i.e. acknowledgements may be this many
+	// intervals late.
+	const int MAX_SNAPSHOTS = 8;
+
+	const std::vector<BlockType> EMPTY_SQUARES;
+
+	// The square in the snapshot changed from, empty outside.
+	BlockType baseSquare(const std::vector<BlockType>& base, int index) {
+		return index < (int) base.size() ? base[index] : BlockType::EMPTY;
+	}
+
+	bool isSameBlock(const Block& block1, const Block& block2) {
+		return block1.getBlockType() == block2.getBlockType()
+			&& block1.getLowestStartRow() == block2.getLowestStartRow()
+			&& block1.getStartColumn() == block2.getStartColumn()
+			&& block1.getCurrentRotation() == block2.getCurrentRotation();
+	}
+
+	bool isSame(const BoardState& state, const TetrisBoard& board) {
+		return state.columns_ == board.getColumns()
+			&& state.next_ == board.getNextBlockType()
+			&& isSameBlock(state.current_, board.getBlock())
+			&& state.squares_ == board.getBoardVector();
+	}
+
+	const BoardState* findState(const std::vector<BoardState>& states, int id) {
+		for (const BoardState& state : states) {
+			if (state.id_ == id) {
+				return &state;
+			}
+		}
+		return nullptr;
+	}
+
+	// Return the state to overwrite with the newest snapshot, the oldest is reused
+	// when all are in use.
+	BoardState& nextState(std::vector<BoardState>& states) {
+		if ((int) states.size() < MAX_SNAPSHOTS) {
+			states.emplace_back();
+		} else {
+			std::rotate(states.begin(), states.begin() + 1, states.end());
+		}
+		return states.back();
+	}
+
+	void writeSigned(BitWriter& writer, int value) {
+		writer.writeVarint(value >= 0 ? value * 2 : -value * 2 - 1, 4);
+	}
+
+	int readSigned(BitReader& reader) {
+		int value = reader.readVarint(4);
+		return value % 2 == 0 ? value / 2 : -(value / 2) - 1;
+	}
+
+	void writeBlocks(BitWriter& writer, const Block& current, BlockType next) {
+		writer.write((int) current.getBlockType(), 3);
+		writer.write(current.getCurrentRotation(), 2);
+		writeSigned(writer, current.getLowestStartRow());
+		writeSigned(writer, current.getStartColumn());
+		writer.write((int) next, 3);
+	}
+
+	void readBlocks(BitReader& reader, Block& current, BlockType& next) {
+		BlockType type = (BlockType) reader.read(3);
+		int rotation = reader.read(2);
+		int lowestStartRow = readSigned(reader);
+		int startColumn = readSigned(reader);
+		current = Block(type, lowestStartRow, startColumn, rotation);
+		next = (BlockType) reader.read(3);
+	}
+
+	// The squares are never BlockType::WALL, i.e. 3 bits are enough.
+	void writeSquares(BitWriter& writer, const std::vector<BlockType>& squares, const std::vector<BlockType>& base) {
+		const int size = squares.size();
+		int index = 0;
+		while (index < size) {
+			const BlockType type = squares[index];
+			const bool same = type == baseSquare(base, index);
+			int length = 1;
+			while (index + length < size) {
+				BlockType square = squares[index + length];
+				if (same ? square != baseSquare(base, index + length) : square != type) {
+					break;
+				}
+				++length;
+			}
+			writer.write(same, 1);
+			if (!same) {
+				writer.write((int) type, 3);
+			}
+			writer.writeVarint(length - 1, 4);
+			index += length;
+		}
+	}
+
+	// Return false if the runs do not add up to the size.
+	bool readSquares(BitReader& reader, std::vector<BlockType>& squares, int size, const std::vector<BlockType>& base) {
+		squares.clear();
+		while ((int) squares.size() < size) {
+			const bool same = reader.read(1) != 0;
+			const BlockType type = same ? BlockType::EMPTY : (BlockType) reader.read(3);
+			const int length = reader.readVarint(4) + 1;
+			if (length <= 0 || length > size - (int) squares.size()) {
+				return false;
+			}
+			for (int i = 0; i < length; ++i) {
+				squares.push_back(same ? baseSquare(base, squares.size()) : type);
+			}
+		}
+		return true;
+	}
+
+} // Anonymous namespace.
+
+BoardSync::BoardSync() : timeLeft_(0) {
+}
+
+void BoardSync::update(double deltaTime, LocalConnection& localConnection, PacketSender& sender, const std::vector<int>& connectionIds) {
+	connectionIds_.assign(connectionIds.begin(), connectionIds.end());
+	if ((int) localBoards_.size() != localConnection.getSize()) {
+		localBoards_.resize(localConnection.getSize());
+	}
+
+	timeLeft_ -= deltaTime;
+	const bool due = timeLeft_ <= 0;
+	if (due) {
+		timeLeft_ = SNAPSHOT_INTERVAL;
+	}
+	if (!sender.isActive() || connectionIds_.empty()) {
+		return;
+	}
+
+	bool movesSent = false;
+	for (auto& player : localConnection) {
+		int playerId = player->getId();
+		if (playerId >= 0 && playerId < (int) localBoards_.size() && (due || localBoards_[playerId].requested_)) {
+			if (!movesSent) {
+				// The snapshot holds the moves, i.e. they must arrive before.
+				localConnection.sendMoves();
+				movesSent = true;
+			}
+			sendBoard(playerId, player->getTetrisBoard(), localConnection.getId(), sender);
+		}
+	}
+}
+
+void BoardSync::sendBoard(int playerId, const TetrisBoard& board, int localConnectionId, PacketSender& sender) {
+	LocalBoard& local = localBoards_[playerId];
+	local.requested_ = false;
+
+	// The newest snapshot known by all connections.
+	int baseId = std::numeric_limits<int>::max();
+	for (int connectionId : connectionIds_) {
+		auto it = local.acks_.find(connectionId);
+		baseId = std::min(baseId, it != local.acks_.end() ? it->second : 0);
+	}
+	const BoardState* base = findState(local.sent_, baseId);
+	if (base != nullptr && base->columns_ != board.getColumns()) {
+		base = nullptr;
+	}
+	if (base != nullptr && isSame(*base, board)) {
+		// All connections have the board already.
+		return;
+	}
+
+	net::Packet packet;
+	packet << PacketType::PLAYER_BOARD;
+	packet << localConnectionId;
+	packet << playerId;
+	packet << Varint(++local.lastId_);
+	packet << Varint(base != nullptr ? base->id_ : 0);
+	packet << Varint(board.getColumns());
+	packet << Varint((int) board.getBoardVector().size());
+	BitWriter writer(packet);
+	writeBlocks(writer, board.getBlock(), board.getNextBlockType());
+	writeSquares(writer, board.getBoardVector(), base != nullptr ? base->squares_ : EMPTY_SQUARES);
+	writer.flush();
+
+	++statistics_.snapshots_;
+	if (base == nullptr) {
+		++statistics_.completeSnapshots_;
+	}
+	statistics_.bytes_ += packet.getSize();
+
+	// The base is not used after this point, it may be overwritten.
+	BoardState& state = nextState(local.sent_);
+	state.id_ = local.lastId_;
+	state.columns_ = board.getColumns();
+	state.squares_.assign(board.getBoardVector().begin(), board.getBoardVector().end());
+	state.current_ = board.getBlock();
+	state.next_ = board.getNextBlockType();
+
+	sender.sendToAll(packet);
+}
+
+void BoardSync::receiveBoard(RemoteConnection& remoteConnection, net::Packet& packet, int localConnectionId, PacketSender& sender) {
+	packet.reset();
+	PacketType type;
+	packet >> type;
+	int id;
+	packet >> id;
+	int playerId;
+	packet >> playerId;
+	Varint snapshotId;
+	packet >> snapshotId;
+	Varint baseId;
+	packet >> baseId;
+	Varint columns;
+	packet >> columns;
+	Varint size;
+	packet >> size;
+	if (playerId < 0 || playerId >= remoteConnection.getNbrOfPlayers() || snapshotId.value_ <= 0
+		|| columns.value_ <= 0 || columns.value_ > BitBoard::MAX_COLUMNS
+		|| size.value_ < 0 || size.value_ > BitBoard::MAX_ROWS * columns.value_) {
+		// Protocol error.
+		throw 1;
+	}
+
+	RemoteBoard& remote = remoteBoards_[std::make_pair(remoteConnection.getId(), playerId)];
+	const BoardState* base = nullptr;
+	if (baseId.value_ != 0) {
+		base = findState(remote.received_, baseId.value_);
+		if (base == nullptr || base->columns_ != columns.value_) {
+			// Not received, e.g. joined after it was sent.
+			requestBoard(remoteConnection.getId(), playerId, localConnectionId, sender);
+			return;
+		}
+	} else {
+		remote.requested_ = false;
+	}
+
+	BoardState state;
+	state.id_ = snapshotId.value_;
+	state.columns_ = columns.value_;
+	BitReader reader(packet);
+	readBlocks(reader, state.current_, state.next_);
+	if (!readSquares(reader, state.squares_, size.value_, base != nullptr ? base->squares_ : EMPTY_SQUARES)) {
+		// Protocol error.
+		throw 1;
+	}
+
+	auto& player = *(remoteConnection.begin() + playerId);
+	const TetrisBoard& board = player->getTetrisBoard();
+	if (board.getColumns() == state.columns_ && !board.isGameOver() && !isSame(state, board)) {
+		++statistics_.resyncs_;
+		player->updateBoard(state.squares_, state.current_, state.next_);
+	}
+	nextState(remote.received_) = std::move(state);
+
+	sendAck(remoteConnection.getId(), playerId, snapshotId.value_, localConnectionId, sender);
+}
+
+void BoardSync::receiveAck(net::Packet& packet) {
+	packet.reset();
+	PacketType type;
+	packet >> type;
+	int connectionId;
+	packet >> connectionId;
+	int playerConnectionId;
+	packet >> playerConnectionId;
+	int playerId;
+	packet >> playerId;
+	Varint snapshotId;
+	packet >> snapshotId;
+
+	// A client does not know its own id, i.e. all other ids are compared.
+	if (std::find(connectionIds_.begin(), connectionIds_.end(), playerConnectionId) != connectionIds_.end()
+		|| playerId < 0 || playerId >= (int) localBoards_.size()) {
+		return;
+	}
+
+	LocalBoard& local = localBoards_[playerId];
+	if (snapshotId.value_ == 0) {
+		local.acks_[connectionId] = 0;
+		local.requested_ = true;
+	} else if (snapshotId.value_ <= local.lastId_) {
+		int& ack = local.acks_[connectionId];
+		ack = std::max(ack, snapshotId.value_);
+	}
+}
+
+void BoardSync::requestBoards(RemoteConnection& remoteConnection, int localConnectionId, PacketSender& sender) {
+	for (int playerId = 0; playerId < remoteConnection.getNbrOfPlayers(); ++playerId) {
+		remoteBoards_[std::make_pair(remoteConnection.getId(), playerId)].requested_ = false;
+		requestBoard(remoteConnection.getId(), playerId, localConnectionId, sender);
+	}
+}
+
+void BoardSync::receiveDesync(RemoteConnection& remoteConnection, int playerId, int localConnectionId, PacketSender& sender) {
+	++statistics_.desyncs_;
+	requestBoard(remoteConnection.getId(), playerId, localConnectionId, sender);
+}
+
+void BoardSync::requestBoard(int connectionId, int playerId, int localConnectionId, PacketSender& sender) {
+	RemoteBoard& remote = remoteBoards_[std::make_pair(connectionId, playerId)];
+	if (!remote.requested_) {
+		// Asked once until a complete snapshot is received.
+		remote.requested_ = true;
+		++statistics_.resyncRequests_;
+		sendAck(connectionId, playerId, 0, localConnectionId, sender);
+	}
+}
+
+void BoardSync::sendAck(int connectionId, int playerId, int snapshotId, int localConnectionId, PacketSender& sender) {
+	net::Packet packet;
+	packet << PacketType::PLAYER_BOARD_ACK;
+	packet << localConnectionId;
+	packet << connectionId;
+	packet << playerId;
+	packet << Varint(snapshotId);
+	sender.sendToAll(packet);
+}
+
+void BoardSync::removeConnection(int connectionId) {
+	for (auto it = remoteBoards_.begin(); it != remoteBoards_.end();) {
+		if (it->first.first == connectionId) {
+			it = remoteBoards_.erase(it);
+		} else {
+			++it;
+		}
+	}
+	for (LocalBoard& local : localBoards_) {
+		local.acks_.erase(connectionId);
+	}
+}
+
+void BoardSync::clear() {
+	localBoards_.clear();
+	remoteBoards_.clear();
+	connectionIds_.clear();
+	timeLeft_ = 0;
+}
@@ -0,0 +1,121 @@
+#ifndef BOARDSYNC_H
+#define BOARDSYNC_H
+
+#include "protocol.h"
+#include "tetrisboard.h"
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+class LocalConnection;
+class RemoteConnection;
+
+// Counts the board snapshots sent, the remote boards found to differ and the remote
+// boards corrected by a snapshot.
+class SyncStatistics {
+public:
+	SyncStatistics() : snapshots_(0), completeSnapshots_(0), bytes_(0), resyncs_(0), desyncs_(0), resyncRequests_(0) {
+	}
+
+	std::int64_t snapshots_;
+	std::int64_t completeSnapshots_; // Snapshots not sent as a change.
+	std::int64_t bytes_;
+	std::int64_t resyncs_;           // Remote boards not the same as the snapshot received.
+	std::int64_t desyncs_;           // Board hashes in the moves received not the same as the remote board.
+	std::int64_t resyncRequests_;    // Complete snapshots asked for.
+};
+
+// The board of a player as sent in a snapshot, known by both the sender and the receivers.
+struct BoardState {
+	int id_;
+	int columns_;
+	std::vector<BlockType> squares_;
+	Block current_;
+	BlockType next_;
+};
+
+// Keeps the boards of the remote players the same as the boards of the local players,
+// also after a divergence or when joining a game already started. The board of each local
+// player is sent periodically as a snapshot, the squares run length encoded as the change
+// from the newest snapshot acknowledged by all connections, or from an empty board if
+// there is none. A receiver missing the snapshot changed from asks for a complete one.
+//
+// PLAYER_BOARD: connection id, player id, then as varints the snapshot id, the id of the
+// snapshot changed from (zero if none), the columns and the number of squares, followed bit
+// packed by the current block: type (3 bits), rotation (2 bits), lowest start row and start
+// column (signed varints, 4 bit groups), the next block (3 bits), and the runs of squares:
+// a bit set if the same as the snapshot changed from, else the type (3 bits), and the
+// length minus one (varint, 4 bit groups).
+// PLAYER_BOARD_ACK: connection id, the connection id of the player, player id and the
+// snapshot id applied as a varint, zero to ask for a complete snapshot.
+class BoardSync {
+public:
+	BoardSync();
+
+	BoardSync(const BoardSync&) = delete;
+	BoardSync& operator=(const BoardSync&) = delete;
+
+	// Send the snapshots due, or asked for, of the local players. The connection ids are
+	// all other connections, all must know PacketType::PLAYER_BOARD.
+	void update(double deltaTime, LocalConnection& localConnection, PacketSender& sender, const std::vector<int>& connectionIds);
+
+	// Apply the PLAYER_BOARD packet to the player in the remote connection and acknowledge it.
+	// The board is only changed if not the same as the snapshot, and not game over.
+	void receiveBoard(RemoteConnection& remoteConnection, net::Packet& packet, int localConnectionId, PacketSender& sender);
+
+	// Handle the PLAYER_BOARD_ACK packet, ignored if not about a local player.
+	void receiveAck(net::Packet& packet);
+
+	// Ask for complete snapshots of the players in the remote connection.
+	void requestBoards(RemoteConnection& remoteConnection, int localConnectionId, PacketSender& sender);
+
+	// The board of the player in the remote connection differs from the board hash in
+	// the moves received. Asks for a complete snapshot, unless already asked for.
+	void receiveDesync(RemoteConnection& remoteConnection, int playerId, int localConnectionId, PacketSender& sender);
+
+	// Forget the snapshots of the connection, e.g. when disconnected. The id may be
+	// used again by a new connection.
+	void removeConnection(int connectionId);
+
+	// Forget all snapshots, e.g. when the game is closed.
+	void clear();
+
+	const SyncStatistics& getStatistics() const {
+		return statistics_;
+	}
+
+private:
+	struct LocalBoard {
+		LocalBoard() : lastId_(0), requested_(false) {
+		}
+
+		std::vector<BoardState> sent_; // The oldest first.
+		std::map<int, int> acks_;      // The newest snapshot acknowledged by each connection.
+		int lastId_;
+		bool requested_;
+	};
+
+	struct RemoteBoard {
+		RemoteBoard() : requested_(false) {
+		}
+
+		std::vector<BoardState> received_; // The oldest first.
+		bool requested_;                   // Until a complete snapshot is received.
+	};
+
+	void sendBoard(int playerId, const TetrisBoard& board, int localConnectionId, PacketSender& sender);
+
+	void requestBoard(int connectionId, int playerId, int localConnectionId, PacketSender& sender);
+
+	void sendAck(int connectionId, int playerId, int snapshotId, int localConnectionId, PacketSender& sender);
+
+	std::vector<LocalBoard> localBoards_; // Index is the player id.
+	std::map<std::pair<int, int>, RemoteBoard> remoteBoards_; // By connection and player id.
+	std::vector<int> connectionIds_;
+	double timeLeft_;
+	SyncStatistics statistics_;
+};
+
+#endif // BOARDSYNC_H
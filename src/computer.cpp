@@ -1,28 +1,10 @@
 #include "computer.h"
 #include "tetrisboard.h"
 
-#include <vector>
 #include <string>
-#include <future>
 
-namespace {
-
-	// All parameters are copied, to avoid thread problems.
-	Ai::State asyncCalculateBestState(RawTetrisBoard board, Ai ai, int depth) {
-		return ai.calculateBestState(board, depth);
-	}
-
-}
-
-Computer::Computer() : Device(true) {
-	currentTurn_ = 0;
-	activeThread_ = false;
-}
-
-Computer::Computer(const Ai& ai) : Device(true) {
-	currentTurn_ = 0;
-	ai_ = ai;
-	activeThread_ = false;
+Computer::Computer(const Ai& ai, const AiService& aiService, int depth) : Device(true),
+	currentTurn_(0), aiHandle_(aiService.createHandle(ai)), depth_(depth), gravityInterval_(1.0) {
 }
 
 Input Computer::currentInput() {
@@ -30,22 +12,35 @@ Input Computer::currentInput() {
 }
 
 std::string Computer::getName() const {
-	return ai_.getName();
+	return aiHandle_.getAi().getName();
+}
+
+void Computer::setGravityInterval(double seconds) {
+	gravityInterval_ = seconds;
 }
 
 void Computer::update(const TetrisBoard& board) {
 	// New block appears?
-	if (currentTurn_ != board.getTurns() && !activeThread_) {
-		activeThread_ = true;
+	if (currentTurn_ != board.getTurns()) {
 		input_ = Input();
+		// A search for an old block is of no use.
+		aiHandle_.cancel();
+		if (!aiHandle_.submit(board, depth_)) {
+			// The cancelled search is still stopping, try again next update.
+			return;
+		}
 		currentTurn_ = board.getTurns();
-		handle_ = std::async(std::launch::async | std::launch::deferred, asyncCalculateBestState, board, ai_, 1);
+		searchDeadline_ = Ai::Clock::now() + std::chrono::duration_cast<Ai::Clock::duration>(
+			std::chrono::duration<double>(gravityInterval_ * 0.5));
 	} else {
-		if (handle_.valid()) {
-			latestState_ = handle_.get();
+		if (aiHandle_.isActive()) {
+			// Wait for the search without blocking the caller, use the best state
+			// so far when the block soon is moved down by gravity.
+			if (!aiHandle_.poll(latestState_)
+				&& (Ai::Clock::now() < searchDeadline_ || !aiHandle_.interrupt(latestState_))) {
+				return;
+			}
 			latestBlock_ = board.getBlock();
-			handle_ = std::future<Ai::State>();
-			activeThread_ = false;
 		}
 		Block current = board.getBlock();
 		Square currentSq = current.getRotationSquare();
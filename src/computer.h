@@ -5,18 +5,15 @@
 #include "block.h"
 #include "rawtetrisboard.h"
 #include "ai.h"
+#include "aiservice.h"
 
-#include <calc/calculator.h>
-
-#include <vector>
+#include <chrono>
 #include <string>
-#include <future>
 
 class Computer : public Device {
 public:
-	Computer();
-
-	Computer(const Ai& ai);
+	// The ai search is done by the service, looking depth blocks ahead.
+	Computer(const Ai& ai, const AiService& aiService, int depth);
 
 	Input currentInput() override;
 
@@ -24,6 +21,9 @@ public:
 
 	void update(const TetrisBoard& board) override;
 
+	// The best state found so far is used when half the interval has passed.
+	void setGravityInterval(double seconds) override;
+
 private:
 	// Calculate and return the best input to achieve the current state.
 	Input calculateInput(Ai::State state) const;
@@ -32,9 +32,10 @@ private:
 	Input input_;
 	Ai::State latestState_;
 	Block latestBlock_;
-	Ai ai_;
-	bool activeThread_;
-	std::future<Ai::State> handle_;
+	AiService::Handle aiHandle_;
+	int depth_;
+	double gravityInterval_;
+	Ai::Clock::time_point searchDeadline_;
 };
 
 #endif // COMPUTER_H
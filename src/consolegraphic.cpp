@@ -6,27 +6,36 @@
 
 #include <console/console.h>
 
+namespace {
+
+	bool isSameBlock(const Block& a, const Block& b) {
+		return a.getBlockType() == b.getBlockType() && a.getLowestStartRow() == b.getLowestStartRow()
+			&& a.getStartColumn() == b.getStartColumn() && a.getCurrentRotation() == b.getCurrentRotation();
+	}
+
+} // Anonymous namespace.
+
 const std::string ConsoleGraphic::SQUARE = "  ";
 
-ConsoleGraphic::ConsoleGraphic() : x_(0), y_(0), console_(nullptr) {
+ConsoleGraphic::ConsoleGraphic() : x_(0), y_(0), rows_(0), columns_(0), console_(nullptr) {
 }
 
 ConsoleGraphic::~ConsoleGraphic() {
-	connection_.disconnect();
 }
 
-void ConsoleGraphic::restart(Player& player, int x, int y, console::Console* console) {
+void ConsoleGraphic::restart(const PlayerSnapshot& player, int x, int y, console::Console* console) {
 	console_ = console;
 	x_ = x + 1;
 	y_ = y + 3;
-	connection_.disconnect();
-	connection_ = player.addGameEventListener(std::bind(&ConsoleGraphic::callback, this, std::placeholders::_1, std::placeholders::_2));
-	playerName_ = player.getName();
-	points_ = 0;
-	level_ = 1;
-	nbrRemovedRows_ = 0;
-
-	callback(GameEvent::RESTARTED, player.getTetrisBoard());
+	playerName_ = player.name_;
+	rows_ = player.rows_ - 4;
+	columns_ = player.columns_;
+	points_ = player.points_;
+	level_ = player.level_;
+	nbrRemovedRows_ = player.clearedRows_;
+	nextBlockType_ = player.next_;
+	currentBlock_ = player.current_;
+	squares_ = player.squares_;
 }
 
 int ConsoleGraphic::getWidth() const {
@@ -37,27 +46,21 @@ int ConsoleGraphic::getHeight() const {
 	return rows_ + 4;
 }
 
-void ConsoleGraphic::callback(GameEvent gameEvent, const TetrisBoard& tetrisBoard) {
-	rows_ = tetrisBoard.getRows() - 4;
-	columns_ = tetrisBoard.getColumns();
-	nextBlockType_ = tetrisBoard.getNextBlockType();
-	currentBlock_ = tetrisBoard.getBlock();
-	nbrRemovedRows_ = tetrisBoard.getRemovedRows();
-	switch (gameEvent) {
-	case GameEvent::RESTARTED:
-	case GameEvent::EXTERNAL_ROWS_ADDED:
-	case GameEvent::CURRENT_BLOCK_UPDATED:
-	case GameEvent::PLAYER_MOVES_BLOCK_DOWN:
-	case GameEvent::PLAYER_MOVES_BLOCK_DOWN_GROUND:
-	case GameEvent::PLAYER_MOVES_BLOCK_LEFT:
-	case GameEvent::PLAYER_MOVES_BLOCK_ROTATE:
-	case GameEvent::PLAYER_MOVES_BLOCK_RIGHT:
-	case GameEvent::GRAVITY_MOVES_BLOCK:
-		drawBoard(tetrisBoard);
-		break;
-	case GameEvent::NEXT_BLOCK_UPDATED:
-		drawNextBlock(tetrisBoard.getNextBlockType());
-		break;
+void ConsoleGraphic::draw(const PlayerSnapshot& player) {
+	if (player.squares_ != squares_ || !isSameBlock(player.current_, currentBlock_)) {
+		squares_ = player.squares_;
+		currentBlock_ = player.current_;
+		drawBoard();
+	}
+	if (player.next_ != nextBlockType_) {
+		nextBlockType_ = player.next_;
+		drawNextBlock(nextBlockType_);
+	}
+	if (player.points_ != points_ || player.level_ != level_ || player.clearedRows_ != nbrRemovedRows_) {
+		points_ = player.points_;
+		level_ = player.level_;
+		nbrRemovedRows_ = player.clearedRows_;
+		drawText();
 	}
 }
 
@@ -81,7 +84,7 @@ void ConsoleGraphic::drawCurrentBlock(const Block& currentBlock) const {
 	}
 }
 
-void ConsoleGraphic::drawBoard(const TetrisBoard& board) const {
+void ConsoleGraphic::drawBoard() const {
 	// Clear board.
 	std::string remove = "";
 	for (int i = 0; i < columns_; ++i) {
@@ -92,32 +95,17 @@ void ConsoleGraphic::drawBoard(const TetrisBoard& board) const {
 	}
 
 	// Draw current block.
-	drawCurrentBlock(board.getBlock());
+	drawCurrentBlock(currentBlock_);
 	
 	// Draw tetris board.
 	for (int row = 0; row < rows_ + 4; ++row) {
 		for (int column = 0; column < columns_; ++column) {
-			BlockType blockType = board.getBlockType(row, column);
+			BlockType blockType = row * columns_ + column < (int) squares_.size() ? squares_[row * columns_ + column] : BlockType::EMPTY;
 			drawSquare(1 + column * 2, rows_ - row - 2, blockType);
 		}
 	}
 }
 
-void ConsoleGraphic::updatePoints(int points) {
-	points_ = points;
-	drawText();
-}
-
-void ConsoleGraphic::updateLevel(int level) {
-	level_ = level;
-	drawText();
-}
-
-void ConsoleGraphic::draw(const TetrisBoard& tetrisBoard) {
-	drawBoard(tetrisBoard);
-	drawStatic();
-}
-
 void ConsoleGraphic::drawStatic() const {
 	// Draw frame around next block.
 	console_->setBackgroundColor(console::Color::WHITE);
@@ -163,8 +151,8 @@ void ConsoleGraphic::drawStatic() const {
 		draw(getWidth() - 2, i - 3, " ");
 	}
 	
+	drawBoard();
 	drawNextBlock(nextBlockType_);
-	drawCurrentBlock(currentBlock_);
 	drawText();
 }
 
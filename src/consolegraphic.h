@@ -1,8 +1,7 @@
 #ifndef CONSOLEGRAPHIC_H
 #define CONSOLEGRAPHIC_H
 
-#include "tetrisgameevent.h"
-#include "tetrisboard.h"
+#include "gamesnapshot.h"
 
 #include <console/console.h>
 
@@ -12,25 +11,18 @@ public:
 
 	~ConsoleGraphic();
 
-	void restart(Player& player, int x, int y, console::Console* console);
+	void restart(const PlayerSnapshot& player, int x, int y, console::Console* console);
 
 	int getWidth() const;
 
 	int getHeight() const;
 
-	void callback(GameEvent gameEvent, const TetrisBoard& tetrisBoard);
-
-	void updatePoints(int points);
-
-	void updateLevel(int level);
-
-	void draw(const TetrisBoard& tetrisBoard);
+	// Draw the parts changed since the last drawn snapshot.
+	void draw(const PlayerSnapshot& player);
 
 	void drawStatic() const;
 
 private:
-	
-
 	void drawText() const;
 	
 	void drawSquare(int x, int y, BlockType blockType) const;
@@ -43,17 +35,17 @@ private:
 
 	void drawNextBlock(BlockType nextBlockType) const;
 	void drawCurrentBlock(const Block& currentBlock) const;
-	void drawBoard(const TetrisBoard& board) const;
+	void drawBoard() const;
 
 	static const std::string SQUARE;
 
-	mw::signals::Connection connection_;
 	std::string playerName_;
 	int x_, y_;
 	int rows_, columns_;
 	int nbrRemovedRows_;
 	BlockType nextBlockType_;
 	Block currentBlock_;
+	std::vector<BlockType> squares_;
 
 	int points_, level_;
 	console::Console* console_;
@@ -13,6 +13,7 @@ ConsoleKeyboard::ConsoleKeyboard(std::string name, console::Key down, console::K
 
 void ConsoleKeyboard::eventUpdate(const console::ConsoleEvent& consoleEvent) {
 	console::Key key = consoleEvent.keyEvent.key;
+	std::lock_guard<std::mutex> lock(mutex_);
 	switch (consoleEvent.type) {
 		case console::ConsoleEventType::KEYDOWN:
 			if (key == down_) {
@@ -5,13 +5,16 @@
 
 #include <console/console.h>
 
+#include <mutex>
 #include <string>
 
 class ConsoleKeyboard : public Device {
 public:
 	ConsoleKeyboard(std::string name, console::Key down, console::Key left, console::Key right, console::Key rotate, console::Key downGround);
 
+	// Called from the simulation thread.
 	Input currentInput() override {
+		std::lock_guard<std::mutex> lock(mutex_);
 		return input_;
 	}
 
@@ -26,6 +29,7 @@ private:
 	console::Key down_, right_, left_, rotate_, downGround_;
 
 	Input input_;
+	std::mutex mutex_;
 };
 
 #endif // CONSOLEKEYBOARD_H
@@ -18,10 +18,27 @@ using namespace console;
 ConsoleTetris::ConsoleTetris() :
 	keyboard1_(std::make_shared<ConsoleKeyboard>("Keyboard 1", console::Key::DOWN, console::Key::LEFT, console::Key::RIGHT, console::Key::UP, console::Key::KEY_DELETE)),
 	keyboard2_(std::make_shared<ConsoleKeyboard>("Keyboard 2", console::Key::KEY_S, console::Key::KEY_A, console::Key::KEY_D, console::Key::KEY_W, console::Key::KEY_Q)),
+	simulationThread_(tetrisGame_),
 	mode_(MENU), option_(GAME),
-	humanPlayers_(1), aiPlayers_(0) {
-
-	tetrisGame_.addCallback(std::bind(&ConsoleTetris::handleConnectionEvent, this, std::placeholders::_1));
+	humanPlayers_(1), aiPlayers_(0),
+	drawnGame_(-1), drawnPaused_(false) {
+
+	aiService_ = std::make_shared<AiService>(TetrisData::getInstance().getAiWorkers());
+	tetrisGame_.setBlockGeneratorMode(TetrisData::getInstance().getBlockGeneratorMode());
+	const std::string boardCorpusFile = TetrisData::getInstance().getBoardCorpusFile();
+	if (!boardCorpusFile.empty()) {
+		auto boardCorpusWriter = std::make_shared<BoardCorpusWriter>();
+		if (boardCorpusWriter->open(boardCorpusFile, TETRIS_HEIGHT, TETRIS_WIDTH)) {
+			tetrisGame_.setBoardCorpusWriter(boardCorpusWriter);
+		}
+	}
+	const std::string replayFile = TetrisData::getInstance().getReplayFile();
+	if (!replayFile.empty()) {
+		auto replayWriter = std::make_shared<ReplayWriter>();
+		if (replayWriter->open(replayFile)) {
+			tetrisGame_.setReplayWriter(replayWriter);
+		}
+	}
 }
 
 void ConsoleTetris::initPreLoop() {
@@ -40,17 +57,18 @@ DevicePtr ConsoleTetris::findAiDevice(std::string name) const {
 
 	for (const Ai& ai : ais) {
 		if (ai.getName() == name) {
-			return std::make_shared<Computer>(ai);
+			return std::make_shared<Computer>(ai, *aiService_, ai.getDepth() > 0 ? ai.getDepth() : TetrisData::getInstance().getAiDepth());
 		}
 	}
-	return std::make_shared<Computer>(ais.back());
+	const Ai& ai = ais.back();
+	return std::make_shared<Computer>(ai, *aiService_, ai.getDepth() > 0 ? ai.getDepth() : TetrisData::getInstance().getAiDepth());
 }
 
 void ConsoleTetris::printGameMenu() {
 	Console::setCursorPosition(0, 0);
 	Console::setTextColor(console::Color::RED);
 	Console::setBackgroundColor(console::Color::BLACK);
-	if (tetrisGame_.isPaused()) {
+	if (drawnPaused_) {
 		print("Menu [Key 1]    Restart [Key 2]    Human -/+ [Key 3/4]    AI -/+ [Key 5/6]    Unpause [P]");
 	} else {
 		print("Menu [Key 1]    Restart [Key 2]    Human -/+ [Key 3/4]    AI -/+ [Key 5/6]    Pause [P]   ");
@@ -67,12 +85,38 @@ void ConsoleTetris::printGame() {
 void ConsoleTetris::update(double deltaTime) {
 	switch (mode_) {
 		case GAME:
-			tetrisGame_.update(deltaTime);
+			drawGame();
 			break;
 	}
+	// Only the drawing, the game is updated in the simulation thread.
 	sleep(1.0 / 60.0);
 }
 
+void ConsoleTetris::drawGame() {
+	const GameSnapshot& snapshot = simulationThread_.readSnapshot();
+	const bool pauseChanged = snapshot.paused_ != drawnPaused_;
+	drawnPaused_ = snapshot.paused_;
+	if (snapshot.game_ != drawnGame_) {
+		drawnGame_ = snapshot.game_;
+		graphicPlayers_.clear();
+
+		int delta = 2;
+		for (const PlayerSnapshot& player : snapshot.players_) {
+			auto& graphic = graphicPlayers_[player.id_];
+			graphic.restart(player, delta, 2, this);
+			delta += graphic.getWidth();
+		}
+		clear();
+		printGame();
+	} else if (pauseChanged) {
+		printGame();
+	}
+
+	for (const PlayerSnapshot& player : snapshot.players_) {
+		graphicPlayers_[player.id_].draw(player);
+	}
+}
+
 void ConsoleTetris::eventUpdate(console::ConsoleEvent& consoleEvent) {
 	switch (consoleEvent.type) {
 		case console::ConsoleEventType::KEYDOWN:
@@ -91,6 +135,8 @@ void ConsoleTetris::eventUpdate(console::ConsoleEvent& consoleEvent) {
 				case console::ConsoleEventType::KEYDOWN:
 					switch (consoleEvent.keyEvent.key) {
 						case console::Key::KEY_1:
+							// The game is paused while in the menu.
+							simulationThread_.stop();
 							mode_ = MENU;
 							printMainMenu();
 							break;
@@ -114,7 +160,9 @@ void ConsoleTetris::eventUpdate(console::ConsoleEvent& consoleEvent) {
 							restartCurrentGame();
 							break;
 						case console::Key::KEY_P:
-							tetrisGame_.pause();
+							simulationThread_.invoke([](TetrisGame& tetrisGame) {
+								tetrisGame.pause();
+							});
 							break;
 					}
 					break;
@@ -186,8 +234,10 @@ void ConsoleTetris::restartCurrentGame() {
 		devices.push_back(activeAis_[i]);
 	}
 
-	tetrisGame_.setPlayers(devices);
-	tetrisGame_.createLocalGame();
+	simulationThread_.invoke([devices](TetrisGame& tetrisGame) {
+		tetrisGame.setPlayers(devices);
+		tetrisGame.createLocalGame();
+	});
 }
 
 void ConsoleTetris::printMainMenu() {
@@ -227,64 +277,6 @@ void ConsoleTetris::drawClear(int x, int y, std::string text, console::Color col
 	print(text);
 }
 
-void ConsoleTetris::handleConnectionEvent(TetrisGameEvent& tetrisEvent) {
-	try {
-		auto& levelChange = dynamic_cast<LevelChange&>(tetrisEvent);
-		graphicPlayers_[levelChange.player_->getId()].updateLevel(levelChange.newLevel_);
-		return;
-	} catch (std::bad_cast exp) {}
-
-	try {
-		auto& pointsChange = dynamic_cast<PointsChange&>(tetrisEvent);
-		graphicPlayers_[pointsChange.player_->getId()].updateLevel(pointsChange.newPoints_);
-		return;
-	} catch (std::bad_cast exp) {}
-
-	try {
-		auto& gameOver = dynamic_cast<GameOver&>(tetrisEvent);
-		return;
-	} catch (std::bad_cast exp) {}
-	
-	try {
-		auto& gamePause = dynamic_cast<GamePause&>(tetrisEvent);
-		printGame();
-		return;
-	} catch (std::bad_cast exp) {}
-
-	try {
-		auto& newConnection = dynamic_cast<NewConnection&>(tetrisEvent);
-		return;
-	} catch (std::bad_cast exp) {}
-
-	try {
-		auto& initGameVar = dynamic_cast<InitGame&>(tetrisEvent);
-		graphicPlayers_.clear();
-
-		int delta = 2;
-		for (auto& player : initGameVar.players_) {
-			auto& graphic = graphicPlayers_[player->getId()];
-			graphic.restart(*player, delta, 2, this);
-			delta += graphic.getWidth();
-		}
-		clear();
-		printGame();
-		return;
-	} catch (std::bad_cast exp) {}
-
-	try {
-		auto& start = dynamic_cast<GameStart&>(tetrisEvent);
-		switch (start.status_) {
-			case GameStart::LOCAL:
-				break;
-			case GameStart::CLIENT:
-				break;
-			case GameStart::SERVER:
-				break;
-		}
-		return;
-	} catch (std::bad_cast exp) {}
-}
-
 void ConsoleTetris::moveMenuDown() {
 	int nbr = (int) option_;
 	++nbr;
@@ -313,6 +305,8 @@ void ConsoleTetris::execute(TetrisMenu option) {
 	case GAME:
 		mode_ = GAME;
 		restartCurrentGame();
+		// From now on the game is only used through the simulation thread.
+		simulationThread_.start();
 		break;
 	case QUIT:
 		mode_ = QUIT;
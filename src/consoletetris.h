@@ -12,6 +12,7 @@
 #include "device.h"
 #include "ai.h"
 #include "tetrisparameters.h"
+#include "simulationthread.h"
 
 #include <console/console.h>
 
@@ -35,14 +36,15 @@ private:
 
 	void printGame();
 
+	// Draw the game from the latest snapshot.
+	void drawGame();
+
 	void draw(int x, int y, std::string text);
 
 	void draw(int x, int y, std::string text, console::Color color);
 
 	void drawClear(int x, int y, std::string text, console::Color color);
 
-	void handleConnectionEvent(TetrisGameEvent& tetrisEvent);
-
 	DevicePtr findAiDevice(std::string name) const;
 
 	void moveMenuUp();
@@ -53,8 +55,10 @@ private:
 	void execute(TetrisMenu option);
 
 	TetrisGame tetrisGame_;
+	SimulationThread simulationThread_; // Declared after the game, i.e. stopped before the game is destroyed.
 
 	std::array<DevicePtr, 3> activeAis_;
+	std::shared_ptr<AiService> aiService_;
 
 	TetrisMenu mode_;
 	TetrisMenu option_;
@@ -63,6 +67,8 @@ private:
 	int aiPlayers_;
 	std::vector<DevicePtr> activePlayers_;
 	std::map<int, ConsoleGraphic> graphicPlayers_;
+	int drawnGame_;
+	bool drawnPaused_;
 	std::array<char, 100 * 100> screen_;
 };
 
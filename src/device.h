@@ -41,6 +41,10 @@ public:
 	virtual void update(const TetrisBoard& board) {
 	}
 
+	// The time in seconds between each gravity move.
+	virtual void setGravityInterval(double seconds) {
+	}
+
 	bool isAi() const {
 		return ai_;
 	}
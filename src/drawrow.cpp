@@ -9,7 +9,7 @@ namespace {
 
 }
 
-DrawRow::DrawRow(int row, const TetrisBoard& board, float squareSize, float lowX, float lowY) :
+DrawRow::DrawRow(int row, const PlayerSnapshot& player, float squareSize, float lowX, float lowY) :
 	fadingTime_(TetrisData::getInstance().getRowFadingTime()), squareSize_(squareSize),
 	movingTime_(TetrisData::getInstance().getRowMovingTime()) {
 
@@ -23,25 +23,41 @@ DrawRow::DrawRow(int row, const TetrisBoard& board, float squareSize, float lowX
 	
 	lowX_ = lowX;
 	lowY_ = lowY;
-	init(row, board);
+	init(row, player);
 }
 
-void DrawRow::init(int row, const TetrisBoard& board) {
+void DrawRow::init(int row, const PlayerSnapshot& player) {
 	row_ = row;
 	oldRow_ = row;
 	graphicRow_ = (float) row;
-	columns_ = board.getColumns();
+	columns_ = player.columns_;
 	timeLeft_ = 0.f;
-	highestBoardRow_ = board.getRows();
+	highestBoardRow_ = player.rows_;
 	alpha_ = 1.f;
 
-	updateVertexData(board);
+	updateVertexData(player);
 }
 
-void DrawRow::handleEvent(GameEvent gameEvent, const TetrisBoard& tetrisBoard) {
+void DrawRow::init(int row, const BoardEvent& boardEvent) {
+	row_ = row;
+	oldRow_ = row;
+	graphicRow_ = (float) row;
+	columns_ = boardEvent.columns_;
+	timeLeft_ = 0.f;
+	highestBoardRow_ = boardEvent.rows_;
+	alpha_ = 1.f;
+
+	blockTypes_.clear();
+	for (int column = 0; column < columns_; ++column) {
+		blockTypes_.push_back(boardEvent.row_ == row ? boardEvent.squares_[column] : BlockType::EMPTY);
+	}
+	updateVertexData();
+}
+
+void DrawRow::handleEvent(const BoardEvent& boardEvent) {
 	if (row_ >= 0) {
-		int rowTobeRemoved = tetrisBoard.getRowToBeRemoved();
-		switch (gameEvent) {
+		int rowTobeRemoved = boardEvent.rowToBeRemoved_;
+		switch (boardEvent.event_) {
 			case GameEvent::ROW_TO_BE_REMOVED:
 				if (rowTobeRemoved < row_) {
 					--row_;
@@ -58,13 +74,23 @@ void DrawRow::handleEvent(GameEvent gameEvent, const TetrisBoard& tetrisBoard) {
 			case GameEvent::ONE_ROW_REMOVED:
 				break;
 			case GameEvent::EXTERNAL_ROWS_ADDED:
-				row_ += tetrisBoard.getNbrExternalRowsAdded();
+				row_ += boardEvent.externalRows_;
 				break;
 			case GameEvent::BLOCK_COLLISION:
-				if (row_ >= 0) {
-					updateVertexData(tetrisBoard);
+			{
+				// The block is the only change to the row.
+				bool changed = false;
+				for (const Square& sq : boardEvent.getBlock()) {
+					if (sq.row_ == row_ && sq.column_ >= 0 && sq.column_ < columns_) {
+						blockTypes_[sq.column_] = sq.blockType_;
+						changed = true;
+					}
 				}
-				break;
+				if (changed) {
+					updateVertexData();
+				}
+			}
+			break;
 		}
 	}
 }
@@ -108,10 +134,10 @@ bool DrawRow::isActive() const {
 	return row_ >= -1 && alpha_ > 0;
 }
 
-void DrawRow::updateVertexData(const TetrisBoard& tetrisBoard) {
+void DrawRow::updateVertexData(const PlayerSnapshot& player) {
 	blockTypes_.clear();
 	for (int column = 0; column < columns_; ++column) {
-		blockTypes_.push_back(tetrisBoard.getBlockType(row_, column));
+		blockTypes_.push_back(player.getBlockType(row_, column));
 	}
 	updateVertexData();
 }
@@ -3,19 +3,21 @@
 
 #include "player.h"
 #include "boardbatch.h"
+#include "boardeventchannel.h"
+#include "gamesnapshot.h"
 
 class DrawRow;
 using DrawRowPtr = std::shared_ptr<DrawRow>;
 
 class DrawRow {
 public:
-	DrawRow(int row, const TetrisBoard& board, float squareSize, float lowX, float lowY);
+	DrawRow(int row, const PlayerSnapshot& player, float squareSize, float lowX, float lowY);
 
 	int getRow() const {
 		return row_;
 	}
 
-	void handleEvent(GameEvent gameEvent, const TetrisBoard& tetrisBoard);
+	void handleEvent(const BoardEvent& boardEvent);
 
 	void update(float deltaTime);
 
@@ -23,7 +25,10 @@ public:
 
 	bool isActive() const;
 
-	void init(int row, const TetrisBoard& board);
+	void init(int row, const PlayerSnapshot& player);
+
+	// Use the squares in the event if it holds the row, else an empty row.
+	void init(int row, const BoardEvent& boardEvent);
 
 	const std::vector<BoardShader::Vertex>& getVertexes() {
 		return vertexes_;
@@ -32,7 +37,7 @@ public:
 	void clear();
 
 private:
-	void updateVertexData(const TetrisBoard& tetrisBoard);
+	void updateVertexData(const PlayerSnapshot& player);
 	void updateVertexData();
 
 	mw::Sprite getSprite(BlockType blockType) const;
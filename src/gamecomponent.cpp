@@ -1,5 +1,6 @@
 #include "gamecomponent.h"
 #include "tetrisgame.h"
+#include "simulationthread.h"
 #include "gamegraphic.h"
 #include "tetrisparameters.h"
 #include "tetrisgameevent.h"
@@ -37,8 +38,11 @@ namespace {
 
 }
 
-GameComponent::GameComponent(TetrisGame& tetrisGame)
-	: tetrisGame_(tetrisGame),
+GameComponent::GameComponent(TetrisGame& tetrisGame, SimulationThread& simulationThread)
+	: graphicPlayers_(std::make_shared<GraphicPlayers>()),
+	connectedPlayers_(graphicPlayers_),
+	tetrisGame_(tetrisGame),
+	simulationThread_(simulationThread),
 	updateMatrix_(true) {
 
 	setGrabFocus(true);
@@ -63,7 +67,7 @@ void GameComponent::draw(const gui::Graphic& graphic, double deltaTime) {
 		float width = 0;
 		float height = 0;
 
-		for (const auto& pair : graphicPlayers_) {
+		for (const auto& pair : *graphicPlayers_) {
 			const GameGraphic& graphic = pair.second;
 			width += graphic.getWidth();
 			height = graphic.getHeight();
@@ -92,7 +96,7 @@ void GameComponent::draw(const gui::Graphic& graphic, double deltaTime) {
 		updateMatrix_ = false;
 	}
 
-	if (!graphicPlayers_.empty()) {
+	if (!graphicPlayers_->empty()) {
 		// Draw boards.
 		TetrisData::getInstance().bindTextureFromAtlas();
 		glEnable(GL_BLEND);
@@ -100,7 +104,7 @@ void GameComponent::draw(const gui::Graphic& graphic, double deltaTime) {
 
 		dynamicBoardBatch_->clear();
 
-		for (auto& pair : graphicPlayers_) {
+		for (auto& pair : *graphicPlayers_) {
 			GameGraphic& graphic = pair.second;
 			graphic.update((float) deltaTime, *dynamicBoardBatch_);
 		}
@@ -110,13 +114,13 @@ void GameComponent::draw(const gui::Graphic& graphic, double deltaTime) {
 		dynamicBoardBatch_->draw();
 		
 		// Draw text.
-		for (auto& pair : graphicPlayers_) {
+		for (auto& pair : *graphicPlayers_) {
 			GameGraphic& graphic = pair.second;
 			graphic.drawText(*dynamicBoardBatch_);
 		}
 
 		// Draw middle text.
-		for (auto& pair : graphicPlayers_) {
+		for (auto& pair : *graphicPlayers_) {
 			GameGraphic& graphic = pair.second;			
 			graphic.drawMiddleText(*dynamicBoardBatch_);
 		}
@@ -124,20 +128,17 @@ void GameComponent::draw(const gui::Graphic& graphic, double deltaTime) {
 	}
 }
 
-void GameComponent::initGame(std::vector<PlayerPtr>& players) {
-	bool showPoints = false;
-	if (players.size() == 1) {
-		showPoints = true;
-	}
-
+void GameComponent::initGame(const std::shared_ptr<GraphicPlayers>& graphicPlayers, const std::vector<PlayerPtr>& players) {
+	middleText_ = mw::Text("", TetrisData::getInstance().getDefaultFont(50), 20);
 	staticBoardBatch_ = std::make_shared<BoardBatch>(boardShader_);
 
-	graphicPlayers_.clear();
+	// The old players are destroyed in this thread, already disconnected.
+	graphicPlayers_ = graphicPlayers;
 
 	float w = 0;
-	for (auto& player : players) {
-		auto& graphic = graphicPlayers_[player];
-		graphic.restart(*staticBoardBatch_, *player, w, 0);
+	for (const auto& player : players) {
+		auto& graphic = graphicPlayers_->find(player)->second;
+		graphic.restart(*staticBoardBatch_, w, 0);
 		w += graphic.getWidth();
 	}
 	staticBoardBatch_->uploadToGraphicCard();
@@ -145,22 +146,42 @@ void GameComponent::initGame(std::vector<PlayerPtr>& players) {
 	updateMatrix_ = true;
 }
 
+void GameComponent::postMiddleText(const std::string& text) {
+	std::vector<PlayerPtr> players;
+	for (const auto& pair : *connectedPlayers_) {
+		if (!pair.first->getTetrisBoard().isGameOver()) {
+			players.push_back(pair.first);
+		}
+	}
+	simulationThread_.post([this, text, players]() {
+		middleText_.setText(text);
+
+		// Update the text for the active players.
+		for (const auto& player : players) {
+			auto it = graphicPlayers_->find(player);
+			if (it != graphicPlayers_->end()) {
+				it->second.setMiddleMessage(middleText_);
+			}
+		}
+	});
+}
+
+void GameComponent::updatePlayer(const PlayerPtr& player, int clearedRows, int points, int level) {
+	auto it = graphicPlayers_->find(player);
+	if (it != graphicPlayers_->end()) {
+		it->second.update(clearedRows, points, level);
+	}
+}
+
 void GameComponent::eventHandler(TetrisGameEvent& tetrisEvent) {
 	// Handle CountDown event.
 	try {
 		auto& countDown = dynamic_cast<CountDown&>(tetrisEvent);
 
 		if (countDown.timeLeft_ > 0) {
-			middleText_.setText("Start in " + std::to_string(countDown.timeLeft_));
+			postMiddleText("Start in " + std::to_string(countDown.timeLeft_));
 		} else {
-			middleText_.setText("");
-		}
-
-		// Update the text for the active players.
-		for (auto& graphic : graphicPlayers_) {
-			if (!graphic.first->getTetrisBoard().isGameOver()) {
-				graphic.second.setMiddleMessage(middleText_);
-			}
+			postMiddleText("");
 		}
 		return;
 	} catch (std::bad_cast exp) {}
@@ -170,41 +191,57 @@ void GameComponent::eventHandler(TetrisGameEvent& tetrisEvent) {
 		auto& gamePause = dynamic_cast<GamePause&>(tetrisEvent);
 
 		if (!gamePause.pause_) {
-			middleText_.setText("");
+			postMiddleText("");
 		} else {
-			middleText_.setText("Paused");
-		}	
-
-		// Update the text for the active players.
-		for (auto& graphic : graphicPlayers_) {
-			if (!graphic.first->getTetrisBoard().isGameOver()) {
-				graphic.second.setMiddleMessage(middleText_);
-			}
+			postMiddleText("Paused");
 		}
 		return;
 	} catch (std::bad_cast exp) {}
 
 	// Handle InitGame event.
 	try {
-		middleText_ = mw::Text("", TetrisData::getInstance().getDefaultFont(50), 20);
 		auto& initGameVar = dynamic_cast<InitGame&>(tetrisEvent);
-		initGame(initGameVar.players_);
+
+		// Connected here, i.e. no board event is missed before the graphic is restarted.
+		for (auto& pair : *connectedPlayers_) {
+			pair.second.disconnect();
+		}
+		auto graphicPlayers = std::make_shared<GraphicPlayers>();
+		for (auto& player : initGameVar.players_) {
+			(*graphicPlayers)[player].connect(*player);
+		}
+		connectedPlayers_ = graphicPlayers;
+
+		std::vector<PlayerPtr> players = initGameVar.players_;
+		simulationThread_.post([this, graphicPlayers, players]() {
+			initGame(graphicPlayers, players);
+		});
 		return;
 	} catch (std::bad_cast exp) {}
 
 	// Handle LevelChange event.
 	try {
 		auto& levelChange = dynamic_cast<LevelChange&>(tetrisEvent);
-		GameGraphic& gg = graphicPlayers_[levelChange.player_];
-		gg.update(levelChange.player_->getClearedRows(), levelChange.player_->getPoints(), levelChange.newLevel_);
+		PlayerPtr player = levelChange.player_;
+		int clearedRows = player->getClearedRows();
+		int points = player->getPoints();
+		int level = levelChange.newLevel_;
+		simulationThread_.post([this, player, clearedRows, points, level]() {
+			updatePlayer(player, clearedRows, points, level);
+		});
 		return;
 	} catch (std::bad_cast exp) {}
 
 	// Handle PointsChange event.
 	try {
 		auto& pointsChange = dynamic_cast<PointsChange&>(tetrisEvent);
-		GameGraphic& gg = graphicPlayers_[pointsChange.player_];
-		gg.update(pointsChange.player_->getClearedRows(), pointsChange.player_->getPoints(), pointsChange.player_->getLevel());
+		PlayerPtr player = pointsChange.player_;
+		int clearedRows = player->getClearedRows();
+		int points = player->getPoints();
+		int level = player->getLevel();
+		simulationThread_.post([this, player, clearedRows, points, level]() {
+			updatePlayer(player, clearedRows, points, level);
+		});
 		return;
 	} catch (std::bad_cast exp) {}
 
@@ -213,16 +250,21 @@ void GameComponent::eventHandler(TetrisGameEvent& tetrisEvent) {
 		auto& gameOver = dynamic_cast<GameOver&>(tetrisEvent);
 		// Points high enough to be saved in the highscore list?
 
-		mw::Text middleText("", TetrisData::getInstance().getDefaultFont(50), 20);
-
-		// Test if the player is a local player, exception otherwise.
+		std::string text;
 		if (tetrisGame_.getNbrOfPlayers() == 1) {
-			middleText.setText("Game over");
+			text = "Game over";
 		} else {
-			middleText.setText(gamePosition(gameOver.position_));
+			text = gamePosition(gameOver.position_);
 		}
 
-		graphicPlayers_[gameOver.player_].setMiddleMessage(middleText);
+		PlayerPtr player = gameOver.player_;
+		simulationThread_.post([this, player, text]() {
+			mw::Text middleText(text, TetrisData::getInstance().getDefaultFont(50), 20);
+			auto it = graphicPlayers_->find(player);
+			if (it != graphicPlayers_->end()) {
+				it->second.setMiddleMessage(middleText);
+			}
+		});
 		return;
 	} catch (std::bad_cast exp) {}
 }
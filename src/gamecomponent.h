@@ -15,33 +15,47 @@
 #include <map>
 
 class TetrisGame;
+class SimulationThread;
 class GameData;
 class TetrisGameEvent;
 
 class GameComponent : public gui::Component {
 public:
-	GameComponent(TetrisGame& tetrisGame);
+	// The game events are handled in the simulation thread and the graphic is
+	// changed in the functions posted to the thread drawing.
+	GameComponent(TetrisGame& tetrisGame, SimulationThread& simulationThread);
 	~GameComponent();
 	
 	// @gui::Component
 	void draw(const gui::Graphic& graphic, double deltaTime) override;
 
-	void initGame(std::vector<PlayerPtr>& player);
-
 	void eventHandler(TetrisGameEvent& tetrisGameEvent);
 
 private:
+	using GraphicPlayers = std::map<PlayerPtr, GameGraphic>;
+
+	void initGame(const std::shared_ptr<GraphicPlayers>& graphicPlayers, const std::vector<PlayerPtr>& players);
+
+	// Post the text to be shown for the players not yet game over.
+	void postMiddleText(const std::string& text);
+
+	void updatePlayer(const PlayerPtr& player, int clearedRows, int points, int level);
+
 	// @gui::Component
 	// Called when the component is resized or moved.
 	void validate() override;
 
-	std::map<PlayerPtr, GameGraphic> graphicPlayers_;
+	std::shared_ptr<GraphicPlayers> graphicPlayers_;
+	// The players receiving board events, only used in the simulation thread. The
+	// map is not changed after created, i.e. safe to read in both threads.
+	std::shared_ptr<GraphicPlayers> connectedPlayers_;
 	BoardShaderPtr boardShader_;
 	
 	std::shared_ptr<BoardBatch> staticBoardBatch_;
 	std::shared_ptr<BoardBatch> dynamicBoardBatch_;
 	
 	TetrisGame& tetrisGame_;
+	SimulationThread& simulationThread_;
 
 	mw::signals::Connection eventConnection_;
 
@@ -11,6 +11,7 @@ GameController::GameController(const mw::GameControllerPtr& gameController, int
 }
 
 Input GameController::currentInput() {
+	std::lock_guard<std::mutex> lock(mutex_);
 	return input_;
 }
 
@@ -36,6 +37,7 @@ void GameController::eventUpdate(const SDL_Event& windowEvent) {
 }
 
 void GameController::updateInput(Uint8 button, bool state) {
+	std::lock_guard<std::mutex> lock(mutex_);
 	switch (button) {
 		case SDL_CONTROLLER_BUTTON_A:
 			input_.downGround_ = state;
@@ -5,10 +5,13 @@
 
 #include <mw/gamecontroller.h>
 
+#include <mutex>
+
 class GameController : public SdlDevice {
 public:
 	GameController(const mw::GameControllerPtr& gameController, int rotateButton = 0, int downButton = 1);
 
+	// Called from the simulation thread.
 	Input currentInput() override;
 	std::string getName() const override;
 
@@ -22,6 +25,7 @@ private:
 	void updateInput(Uint8 button, bool state);
 
 	Input input_;
+	std::mutex mutex_;
 	mw::GameControllerPtr gameController_;
 	int rotateButton_, downButton_;
 	std::string playerName_;
@@ -45,30 +45,35 @@ namespace {
 }
 
 GameGraphic::~GameGraphic() {
-	connection_.disconnect();
+	events_.disconnect();
 }
 
-void GameGraphic::restart(BoardBatch& boardBatch, Player& player, float x, float y) {
+void GameGraphic::connect(Player& player) {
+	events_.connect(player);
+	player.createSnapshot(player_);
+}
+
+void GameGraphic::disconnect() {
+	events_.disconnect();
+}
+
+void GameGraphic::restart(BoardBatch& boardBatch, float x, float y) {
 	level_ = -1;
 	points_ = -1;
 	clearedRows_ = -1;
 
-	connection_.disconnect();
-	connection_ = player.addGameEventListener(std::bind(&GameGraphic::callback, this, std::placeholders::_1, std::placeholders::_2));
-
-	initStaticBackground(boardBatch, x, y, player);
+	initStaticBackground(boardBatch, x, y);
 	showPoints_ = true;
 
-	update(player.getClearedRows(), player.getPoints(), player.getLevel());
+	update(player_.clearedRows_, player_.points_, player_.level_);
 }
 
-void GameGraphic::initStaticBackground(BoardBatch& staticBoardBatch, float lowX, float lowY, Player& player) {
+void GameGraphic::initStaticBackground(BoardBatch& staticBoardBatch, float lowX, float lowY) {
 	const float squareSize = TetrisData::getInstance().getTetrisSquareSize();
 	const float borderSize = TetrisData::getInstance().getTetrisBorderSize();
 
-	const TetrisBoard& tetrisBoard = player.getTetrisBoard();
-	const int columns = tetrisBoard.getColumns();
-	const int rows = tetrisBoard.getRows();
+	const int columns = player_.columns_;
+	const int rows = player_.rows_;
 
 	const float middleDistance = 5;
 	const float rightDistance = 5;
@@ -122,18 +127,18 @@ void GameGraphic::initStaticBackground(BoardBatch& staticBoardBatch, float lowX,
 		infoSize, infoSize,
 		TetrisData::getInstance().getStartAreaColor());
 
-	nextBlock_ = DrawBlock(Block(tetrisBoard.getNextBlockType(), 0, 0), tetrisBoard.getRows(), squareSize, x + squareSize * 2.5f, y + squareSize * 2.5f, true);
+	nextBlock_ = DrawBlock(Block(player_.next_, 0, 0), rows, squareSize, x + squareSize * 2.5f, y + squareSize * 2.5f, true);
 
 	mw::Font font = TetrisData::getInstance().getDefaultFont(30);
-	name_ = DrawText(player.getName(), font, x, y + squareSize * 5, 8.f);
+	name_ = DrawText(player_.name_, font, x, y + squareSize * 5, 8.f);
 	
-	level_ = player.getLevel();
+	level_ = player_.level_;
 	textLevel_ = DrawText("Level " + std::to_string(level_), font, x, y - 20, 8.f);
 
-	points_ = player.getPoints();
+	points_ = player_.points_;
 	textPoints_ = DrawText("Points " + std::to_string(points_), font, x, y - 20 - 12, 8.f);
 
-	clearedRows_ = player.getClearedRows();
+	clearedRows_ = player_.clearedRows_;
 	textClearedRows_ = DrawText("Rows " + std::to_string(clearedRows_), font, x, y - 20 - 12 * 2, 8.f);
 
 	const mw::Color borderColor = TetrisData::getInstance().getBorderColor();
@@ -205,13 +210,13 @@ void GameGraphic::initStaticBackground(BoardBatch& staticBoardBatch, float lowX,
 
 	rows_.clear();
 
-	currentBlock_ = DrawBlock(tetrisBoard.getBlock(), tetrisBoard.getRows(), squareSize,
+	currentBlock_ = DrawBlock(player_.current_, rows, squareSize,
 		lowX + borderSize, lowY + borderSize, false);
 
 	// Add rows to represent the board.
 	// Add free rows to represent potential rows, e.g. the board receives external rows.
 	for (int row = 0; row < rows; ++row) {
-		auto drawRow = std::make_shared<DrawRow>(row, tetrisBoard, squareSize, lowX + borderSize, lowY + borderSize);
+		auto drawRow = std::make_shared<DrawRow>(row, player_, squareSize, lowX + borderSize, lowY + borderSize);
 		auto freeRow = std::make_shared<DrawRow>(*drawRow);
 		freeRow->clear(); // Make all elements to only contain blocktype empty squares.
 		rows_.push_back(drawRow);
@@ -221,9 +226,13 @@ void GameGraphic::initStaticBackground(BoardBatch& staticBoardBatch, float lowX,
 	middleText_ = DrawText(lowX + borderSize + squareSize * columns * 0.5f, lowY + height_ * 0.5f);
 }
 
-void GameGraphic::callback(GameEvent gameEvent, const TetrisBoard& tetrisBoard) {
-	for (auto& row : rows_) {
-		row->handleEvent(gameEvent, tetrisBoard);
+void GameGraphic::handleEvent(const BoardEvent& boardEvent) {
+	const GameEvent gameEvent = boardEvent.event_;
+	if (gameEvent != GameEvent::EXTERNAL_ROWS_ADDED || boardEvent.row_ == boardEvent.externalRows_ - 1) {
+		// Only once for all added rows.
+		for (auto& row : rows_) {
+			row->handleEvent(boardEvent);
+		}
 	}
 	rows_.remove_if([&](const DrawRowPtr& row) {
 		if (!row->isAlive()) {
@@ -238,22 +247,32 @@ void GameGraphic::callback(GameEvent gameEvent, const TetrisBoard& tetrisBoard)
 		case GameEvent::BLOCK_COLLISION:
 			break;
 		case GameEvent::RESTARTED:
+			// The whole board, one row in each event.
+			if (boardEvent.row_ == 0) {
+				for (auto& row : rows_) {
+					row->clear();
+					freeRows_.push_front(row);
+				}
+				rows_.clear();
+			}
+			addEmptyRowTop(boardEvent);
+			currentBlock_.update(boardEvent.getBlock());
+			nextBlock_.update(Block(boardEvent.next_, 0, 0));
+			textClearedRows_.update("Rows " + std::to_string(boardEvent.removedRows_));
 			break;
 		case GameEvent::EXTERNAL_ROWS_ADDED:
-		{
-			int rows = tetrisBoard.getNbrExternalRowsAdded();
-			for (int row = 0; row < rows; ++row) {
-				addDrawRowBottom(tetrisBoard, rows - row - 1);
+			// One event for each added row, the lowest row last.
+			addDrawRowBottom(boardEvent, boardEvent.row_);
+			if (boardEvent.row_ == 0) {
+				int highestRow = boardEvent.boardRows_;
+				assert(rows_.size() - highestRow >= 0); // Something is wrong. Should not be posssible.
+				for (int i = 0; i < (int) rows_.size() - highestRow; ++i) { // Remove unneeded empty rows at the top.
+					rows_.pop_back();
+				}
 			}
-			int highestRow = tetrisBoard.getBoardVector().size() / tetrisBoard.getColumns();
-			assert(rows_.size() - highestRow >= 0); // Something is wrong. Should not be posssible.
-			for (int i = 0; i < (int) rows_.size() - highestRow; ++i) { // Remove unneeded empty rows at the top.
-				rows_.pop_back();
-			}
-		}
-		break;
+			break;
 		case GameEvent::NEXT_BLOCK_UPDATED:
-			nextBlock_.update(Block(tetrisBoard.getNextBlockType(), 0, 0));
+			nextBlock_.update(Block(boardEvent.next_, 0, 0));
 			break;
 		case GameEvent::CURRENT_BLOCK_UPDATED:
 			// Fall through!
@@ -262,46 +281,51 @@ void GameGraphic::callback(GameEvent gameEvent, const TetrisBoard& tetrisBoard)
 		case GameEvent::PLAYER_MOVES_BLOCK_LEFT:
 			// Fall through!
 		case GameEvent::PLAYER_MOVES_BLOCK_RIGHT:
-			currentBlock_.update(tetrisBoard.getBlock());
+			currentBlock_.update(boardEvent.getBlock());
 			break;
 		case GameEvent::PLAYER_MOVES_BLOCK_DOWN_GROUND:
 			blockDownGround_ = true;
-			latestBlockDownGround_ = tetrisBoard.getBlock();
+			latestBlockDownGround_ = boardEvent.getBlock();
 			break;
 		case GameEvent::PLAYER_MOVES_BLOCK_DOWN:
 			if (blockDownGround_) {
-				currentBlock_.updateDown(tetrisBoard.getBlock());
+				currentBlock_.updateDown(boardEvent.getBlock());
 				blockDownGround_ = false;
 			}
 			// Fall through!
 		case GameEvent::GRAVITY_MOVES_BLOCK:
-			currentBlock_.update(tetrisBoard.getBlock());
+			currentBlock_.update(boardEvent.getBlock());
 			break;
 		case GameEvent::ROW_TO_BE_REMOVED:
-			textClearedRows_.update("Rows " + std::to_string(tetrisBoard.getRemovedRows()));
+			textClearedRows_.update("Rows " + std::to_string(boardEvent.removedRows_));
 		break;
 		case GameEvent::ONE_ROW_REMOVED:
-			addDrawRowAtTheTop(tetrisBoard, 1);
+			addDrawRowAtTheTop(boardEvent, 1);
 			break;
 		case GameEvent::TWO_ROW_REMOVED:
-			addDrawRowAtTheTop(tetrisBoard, 2);
+			addDrawRowAtTheTop(boardEvent, 2);
 			break;
 		case GameEvent::THREE_ROW_REMOVED:
-			addDrawRowAtTheTop(tetrisBoard, 3);
+			addDrawRowAtTheTop(boardEvent, 3);
 			break;
 		case GameEvent::FOUR_ROW_REMOVED:
-			addDrawRowAtTheTop(tetrisBoard, 4);
+			addDrawRowAtTheTop(boardEvent, 4);
 			break;
 	}
 }
 
-void GameGraphic::addDrawRowAtTheTop(const TetrisBoard& tetrisBoard, int nbr) {
+void GameGraphic::addDrawRowAtTheTop(const BoardEvent& boardEvent, int nbr) {
 	for (int i = 0; i < nbr; ++i) {
-		addEmptyRowTop(tetrisBoard); // Add them in ascending order.
+		addEmptyRowTop(boardEvent); // Add them in ascending order.
 	}
 }
 
 void GameGraphic::update(float deltaTime, BoardBatch& dynamicBoardBatch) {
+	BoardEvent boardEvent;
+	while (events_.pop(boardEvent)) {
+		handleEvent(boardEvent);
+	}
+
 	currentBlock_.update(deltaTime);
 	dynamicBoardBatch.add(currentBlock_.getVertexes());
 	dynamicBoardBatch.add(nextBlock_.getVertexes());
@@ -380,22 +404,22 @@ void GameGraphic::setName(std::string name) {
 	name_.update(name);
 }
 
-void GameGraphic::addEmptyRowTop(const TetrisBoard& tetrisBoard) {
+void GameGraphic::addEmptyRowTop(const BoardEvent& boardEvent) {
 	assert(!freeRows_.empty()); // Should never be empty.
 	if (!freeRows_.empty()) { // Just in case empty, but the game should be over anyway.
 		auto drawRow = freeRows_.back();
 		freeRows_.pop_back();
-		drawRow->init(rows_.size(), tetrisBoard);
+		drawRow->init(rows_.size(), boardEvent);
 		rows_.push_back(drawRow);
 	}
 }
 
-void GameGraphic::addDrawRowBottom(const TetrisBoard& tetrisBoard, int row) {
+void GameGraphic::addDrawRowBottom(const BoardEvent& boardEvent, int row) {
 	assert(!freeRows_.empty()); // Should never be empty.
 	if (!freeRows_.empty()) {
 		auto drawRow = freeRows_.back();
 		freeRows_.pop_back();
-		drawRow->init(row, tetrisBoard);
+		drawRow->init(row, boardEvent);
 		rows_.push_front(drawRow); // Add as the lowest row, i.e. on the bottom.
 	}
 }
@@ -10,11 +10,12 @@
 #include "drawtext.h"
 #include "mat44.h"
 #include "boardbatch.h"
+#include "boardeventchannel.h"
+#include "gamesnapshot.h"
 
 #include <mw/font.h>
 #include <mw/text.h>
 #include <mw/sprite.h>
-#include <mw/signal.h>
 
 #include <gui/component.h>
 
@@ -28,7 +29,17 @@ public:
 
 	~GameGraphic();
 
-	void restart(BoardBatch& boardBatch, Player& player, float x, float y);
+	// Receive the board events of the player and copy the state of the player used
+	// by restart. Called in the thread updating the game, i.e. not while the board
+	// of the player is updated.
+	void connect(Player& player);
+
+	// Stop receiving board events. Called in the thread updating the game.
+	void disconnect();
+
+	// Draw the player as it was when connected, the board events after are handled
+	// in update.
+	void restart(BoardBatch& boardBatch, float x, float y);
 
 	void update(int clearedRows, int points, int level);
 
@@ -40,6 +51,7 @@ public:
 		return height_;
 	}
 
+	// Handle the board events since the last call and add the board to the batch.
 	void update(float deltaTime, BoardBatch& dynamicBoardBatch);
 
 	void setMiddleMessage(const mw::Text& text);
@@ -54,20 +66,20 @@ public:
 
 	void setName(std::string name);
 
-	void callback(GameEvent gameEvent, const TetrisBoard& tetrisBoard);
-
 	void drawText(BoardBatch& batch);
 
 	void drawMiddleText(BoardBatch& batch);
 
 private:
-	void initStaticBackground(BoardBatch& boardBatch, float lowX, float lowY, Player& player);
+	void initStaticBackground(BoardBatch& boardBatch, float lowX, float lowY);
+
+	void handleEvent(const BoardEvent& boardEvent);
 
-	void addDrawRowAtTheTop(const TetrisBoard& tetrisBoard, int nbr);
+	void addDrawRowAtTheTop(const BoardEvent& boardEvent, int nbr);
 
-	void addEmptyRowTop(const TetrisBoard& tetrisBoard);
+	void addEmptyRowTop(const BoardEvent& boardEvent);
 
-	void addDrawRowBottom(const TetrisBoard& tetrisBoard, int row);
+	void addDrawRowBottom(const BoardEvent& boardEvent, int row);
 
 	std::list<DrawRowPtr> rows_;
 	std::list<DrawRowPtr> freeRows_;
@@ -79,7 +91,8 @@ private:
 	Block latestBlockDownGround_;
 	bool blockDownGround_;
 
-	mw::signals::Connection connection_;
+	PlayerSnapshot player_; // The player when connected.
+	BoardEventChannel events_;
 	float width_, height_;
 	bool showPoints_;
 };
@@ -0,0 +1,165 @@
+#include "gameroom.h"
+
+#include <algorithm>
+
+const int GameRoom::MAX_CONNECTIONS;
+
+GameRoom::GameRoom(int id, int width, int height) :
+	id_(id), width_(width), height_(height) {
+}
+
+void GameRoom::addConnection(const net::ConnectionPtr& connection) {
+	if ((int) connections_.size() >= MAX_CONNECTIONS) {
+		connection->stop();
+		return;
+	}
+
+	// The lowest id not in use, ids are sent as one byte.
+	int connectionId = SERVER_CONNECTION_ID + 1;
+	while (std::any_of(connections_.begin(), connections_.end(), [connectionId](const std::shared_ptr<RemoteConnection>& remote) {
+		return remote->getId() == connectionId;
+	})) {
+		++connectionId;
+	}
+	auto newRemote = std::make_shared<RemoteConnection>(connectionId, connection);
+	newRemote->resizeBoard(width_, height_);
+	connections_.push_back(newRemote);
+
+	// Send game info to the new connection.
+	connection->send(getBoardSize());
+
+	// Send connection info of all connections to the new connection.
+	connection->send(getServerInfo());
+	connection->send(getServerEncodingInfo());
+	for (auto& remote : connections_) {
+		if (newRemote != remote) {
+			newRemote->send(remote->getClientInfo());
+			newRemote->send(remote->getEncodingInfo());
+		}
+	}
+
+	// Send the new connection info to the old connections.
+	sendToAllExcept(newRemote.get(), newRemote->getClientInfo());
+}
+
+int GameRoom::update() {
+	int packets = 0;
+	droppedConnections_.clear();
+	for (auto& remote : connections_) {
+		net::Packet packet;
+		while (remote->pollReceivePacket(packet)) {
+			++packets;
+			try {
+				receive(*remote, packet);
+			} catch (int) {
+				// Protocol error, the connection is dropped.
+				++statistics_.protocolErrors_;
+				droppedConnections_.push_back(remote->getId());
+				break;
+			}
+		}
+	}
+
+	for (auto it = connections_.begin(); it != connections_.end();) {
+		int connectionId = (*it)->getId();
+		if ((*it)->isActive() && std::find(droppedConnections_.begin(), droppedConnections_.end(), connectionId) == droppedConnections_.end()) {
+			++it;
+			continue;
+		}
+		it = connections_.erase(it);
+		boardSync_.removeConnection(connectionId);
+
+		// Signal all connections that one connection has disconnected.
+		net::Packet packet;
+		packet << PacketType::CONNECTION_DISCONNECT;
+		packet << connectionId;
+		sendToAll(packet);
+	}
+	return packets;
+}
+
+void GameRoom::sendToAll(const net::Packet& packet) const {
+	sendToAllExcept(nullptr, packet);
+}
+
+void GameRoom::sendToAllExcept(const RemoteConnection* remoteSendNot, const net::Packet& packet) const {
+	for (auto& remote : connections_) {
+		if (remoteSendNot != remote.get()) {
+			remote->send(packet);
+		}
+	}
+}
+
+void GameRoom::receive(RemoteConnection& remoteConnection, net::Packet& packet) {
+	packet.reset();
+	PacketType type;
+	packet >> type;
+	packet[2] = remoteConnection.getId(); // Set the connection id. The remote has no obligation to use the correct id.
+	++statistics_.packets_;
+	statistics_.bytes_ += packet.getSize();
+
+	if (type == PacketType::BOARD_SIZE) {
+		// The room owns the board size, i.e. the board of the sender is changed back
+		// and the other connections are not affected.
+		remoteConnection.send(getBoardSize());
+		return;
+	}
+
+	if (type < PacketType::PAUSE || type > PacketType::CONNECTION_ENCODING) {
+		// Protocol error, unknown packet.
+		throw 1;
+	}
+
+	// Parsed before sent through, i.e. a broken packet is not received by the other
+	// connections.
+	switch (type) {
+		case PacketType::PLAYER_BOARD:
+			boardSync_.receiveBoard(remoteConnection, packet, SERVER_CONNECTION_ID, *this);
+			break;
+		case PacketType::PLAYER_BOARD_ACK:
+			// No players of its own.
+			break;
+		case PacketType::PLAYER_MOVE_COMPACT:
+			remoteConnection.receive(packet);
+			for (int playerId : remoteConnection.getDesyncedPlayers()) {
+				boardSync_.receiveDesync(remoteConnection, playerId, SERVER_CONNECTION_ID, *this);
+			}
+			remoteConnection.clearDesyncedPlayers();
+			break;
+		case PacketType::CONNECTION_ENCODING:
+			remoteConnection.receive(packet);
+			if (remoteConnection.getEncodingVersion() >= SNAPSHOT_ENCODING_VERSION) {
+				boardSync_.requestBoards(remoteConnection, SERVER_CONNECTION_ID, *this);
+			}
+			break;
+		default:
+			remoteConnection.receive(packet);
+			break;
+	}
+
+	// Send through to all connections.
+	sendToAllExcept(&remoteConnection, packet);
+}
+
+net::Packet GameRoom::getBoardSize() const {
+	net::Packet packet;
+	packet << PacketType::BOARD_SIZE;
+	packet << SERVER_CONNECTION_ID;
+	packet << width_ << height_;
+	return packet;
+}
+
+net::Packet GameRoom::getServerInfo() const {
+	net::Packet packet;
+	packet << PacketType::CONNECTION_INFO;
+	packet << SERVER_CONNECTION_ID;
+	return packet;
+}
+
+net::Packet GameRoom::getServerEncodingInfo() const {
+	net::Packet packet;
+	packet << PacketType::CONNECTION_ENCODING;
+	packet << SERVER_CONNECTION_ID;
+	packet << ENCODING_VERSION;
+	return packet;
+}
@@ -0,0 +1,93 @@
+#ifndef GAMEROOM_H
+#define GAMEROOM_H
+
+#include "boardsync.h"
+#include "protocol.h"
+#include "remoteconnection.h"
+
+#include <net/connection.h>
+#include <net/packet.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Counts the packets sent through a room.
+class RoomStatistics {
+public:
+	RoomStatistics() : packets_(0), bytes_(0), protocolErrors_(0) {
+	}
+
+	std::int64_t packets_;
+	std::int64_t bytes_;
+	std::int64_t protocolErrors_; // Connections dropped due to a broken packet.
+};
+
+// A game hosted by the dedicated server, i.e. the server for the connections in the
+// room but without players of its own. The packets from each connection are parsed and
+// sent through to the other connections, as TetrisGame does for a server game. A
+// connection sending a broken packet is dropped, and the packet not sent through. The boards
+// of the players are followed, and corrected by snapshots, to inform the connections
+// joining later.
+class GameRoom : public PacketSender {
+public:
+	// The connection ids are sent as one signed byte, and the server has id 0.
+	static const int MAX_CONNECTIONS = 127;
+
+	GameRoom(int id, int width, int height);
+
+	GameRoom(const GameRoom&) = delete;
+	GameRoom& operator=(const GameRoom&) = delete;
+
+	int getId() const {
+		return id_;
+	}
+
+	// Add the connection and send it the board size and the connections already in
+	// the room. The board size is fixed. The connection is stopped if the room is full.
+	void addConnection(const net::ConnectionPtr& connection);
+
+	// Receive and send through all packets, and remove the disconnected connections.
+	// Return the number of packets received.
+	int update();
+
+	int getNbrOfConnections() const {
+		return connections_.size();
+	}
+
+	const RoomStatistics& getStatistics() const {
+		return statistics_;
+	}
+
+	const SyncStatistics& getSyncStatistics() const {
+		return boardSync_.getStatistics();
+	}
+
+	// @PacketSender
+	void sendToAll(const net::Packet& packet) const override;
+
+	// @PacketSender
+	bool isActive() const override {
+		return !connections_.empty();
+	}
+
+private:
+	void sendToAllExcept(const RemoteConnection* remoteSendNot, const net::Packet& packet) const;
+
+	void receive(RemoteConnection& remoteConnection, net::Packet& packet);
+
+	net::Packet getBoardSize() const;
+
+	net::Packet getServerInfo() const;
+
+	net::Packet getServerEncodingInfo() const;
+
+	std::vector<std::shared_ptr<RemoteConnection>> connections_;
+	std::vector<int> droppedConnections_; // Reused each update.
+	BoardSync boardSync_;
+	RoomStatistics statistics_;
+	const int id_;
+	const int width_, height_; // Owned by the room, BOARD_SIZE from the connections is refused.
+};
+
+#endif // GAMEROOM_H
@@ -0,0 +1,51 @@
+#ifndef GAMESNAPSHOT_H
+#define GAMESNAPSHOT_H
+
+#include "block.h"
+
+#include <string>
+#include <vector>
+
+// A copy of the state of a player, i.e. safe to use in another thread than the game.
+class PlayerSnapshot {
+public:
+	PlayerSnapshot() : id_(0), ai_(false), level_(0), points_(0), clearedRows_(0), rows_(0), columns_(0),
+		next_(BlockType::EMPTY), gameOver_(false) {
+	}
+
+	// Return the same as TetrisBoard::getBlockType.
+	BlockType getBlockType(int row, int column) const {
+		if (column < 0 || column >= columns_ || row < 0) {
+			return BlockType::WALL;
+		}
+		if (row * columns_ + column >= (int) squares_.size()) {
+			return BlockType::EMPTY;
+		}
+		return squares_[row * columns_ + column];
+	}
+
+	int id_;
+	std::string name_;
+	bool ai_;
+	int level_, points_, clearedRows_;
+	int rows_, columns_;
+	std::vector<BlockType> squares_;
+	Block current_;
+	BlockType next_;
+	bool gameOver_;
+};
+
+// A copy of the game state after a simulation tick.
+class GameSnapshot {
+public:
+	GameSnapshot() : tick_(0), game_(0), paused_(false), countDown_(0) {
+	}
+
+	int tick_;
+	int game_;      // Changed when a new game is started, i.e. the players may have changed.
+	bool paused_;
+	int countDown_; // Whole seconds left before the game starts, 0 if started.
+	std::vector<PlayerSnapshot> players_;
+};
+
+#endif // GAMESNAPSHOT_H
@@ -17,6 +17,7 @@ Keyboard::Keyboard(std::string name,
 }
 
 Input Keyboard::currentInput() {
+	std::lock_guard<std::mutex> lock(mutex_);
 	return input_;
 }
 
@@ -26,6 +27,7 @@ std::string Keyboard::getName() const {
 
 void Keyboard::eventUpdate(const SDL_Event& windowEvent) {
 	SDL_Keycode key = windowEvent.key.keysym.sym;
+	std::lock_guard<std::mutex> lock(mutex_);
 
 	switch (windowEvent.type) {
 	case SDL_KEYDOWN:
@@ -6,10 +6,13 @@
 #include <SDL.h>
 #include <SDL.h>
 
+#include <mutex>
+
 class Keyboard : public SdlDevice {
 public:
 	Keyboard(std::string name, SDL_Keycode down, SDL_Keycode left, SDL_Keycode right, SDL_Keycode rotate, SDL_Keycode downGround);
 
+	// Called from the simulation thread.
 	Input currentInput() override;
 	std::string getName() const override;
 
@@ -17,6 +20,7 @@ private:
 	void eventUpdate(const SDL_Event& windowEvent) override;
 
 	Input input_;
+	std::mutex mutex_;
 	SDL_Keycode down_, right_, left_, rotate_, downGround_;
 	std::string name_;
 	std::string playerName_;
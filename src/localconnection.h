@@ -2,9 +2,16 @@
 #define LOCALCONNECTION_H
 
 #include "localplayer.h"
+#include "movebatch.h"
 #include "protocol.h"
 #include "connection.h"
+#include "blockgenerator.h"
+#include "tetrisboard.h"
+#include "boardcorpus.h"
+#include "replay.h"
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 // Hold information about all local players.
@@ -15,25 +22,80 @@ public:
 
 	LocalConnection(PacketSender& packetSender) :
 		packetSender_(packetSender),
+		moveBatch_(packetSender),
 		timeStep_(1.0/60),
 		accumulator_(0),
-		id_(UNDEFINED_CONNECTION_ID) {
+		id_(UNDEFINED_CONNECTION_ID),
+		seed_(BlockGenerator::createSeed()),
+		gameSeed_(seed_),
+		blockGeneratorMode_(BlockGenerator::Mode::UNIFORM),
+		rowGenerator_(createRowSeed()) {
+	}
+
+	// Used from the next game.
+	void setBlockGeneratorMode(BlockGenerator::Mode mode) {
+		blockGeneratorMode_ = mode;
+	}
+
+	// The seed for the next game, the following games get seeds derived from it,
+	// i.e. the same seed reproduces the blocks for all players in all games.
+	void setSeed(std::uint64_t seed) {
+		seed_ = seed;
+	}
+
+	// All players save their positions to the corpus, null to stop saving.
+	void setBoardCorpusWriter(const std::shared_ptr<BoardCorpusWriter>& boardCorpusWriter) {
+		boardCorpusWriter_ = boardCorpusWriter;
+		for (auto& player : players_) {
+			player->setBoardCorpusWriter(boardCorpusWriter_);
+		}
+	}
+
+	// Record all games started with setPlayers or restart, null to stop recording.
+	void setReplayWriter(const std::shared_ptr<ReplayWriter>& replayWriter) {
+		endReplay();
+		replayWriter_ = replayWriter;
+		for (auto& player : players_) {
+			player->setReplayWriter(replayWriter_);
+		}
+	}
+
+	// The seed used by the current game.
+	std::uint64_t getGameSeed() const {
+		return gameSeed_;
+	}
+
+	// Generate a row to add to a player, the rows are derived from the game seed too.
+	std::vector<BlockType> generateRow(const RawTetrisBoard& board, double squaresPerLength) {
+		return ::generateRow(board, squaresPerLength, rowGenerator_);
 	}
 
 	void setPlayers(int width, int height, const std::vector<DevicePtr>& devices) {
+		sendMoves();
 		players_.clear();
+		nextSeed();
 		for (const auto& device : devices) {
+			BlockGenerator blockGenerator = createBlockGenerator(players_.size());
+			BlockType current = blockGenerator.generateBlockType();
+			BlockType next = blockGenerator.generateBlockType();
 			auto player = std::make_shared<LocalPlayer>(id_, players_.size(), width, height,
-				randomBlockType(), randomBlockType(), device, packetSender_);
+				current, next, device, moveBatch_);
+			player->setBlockGenerator(blockGenerator);
+			player->setBoardCorpusWriter(boardCorpusWriter_);
+			player->setReplayWriter(replayWriter_);
 			players_.push_back(player);
 		}
+		startReplay();
 		
 		if (packetSender_.isActive()) {
 			packetSender_.sendToAll(getClientInfo());
+			packetSender_.sendToAll(getEncodingInfo());
 		}
 	}
 
 	void removeAllPlayers() {
+		sendMoves();
+		endReplay();
 		players_.clear();
 	}
 
@@ -43,15 +105,26 @@ public:
 		
 		auto player = std::make_shared<LocalPlayer>(id_, players_.size(), width, height,
 			board, levelUpCounter, points, level,
-			current, next, device, packetSender_);
+			current, next, device, moveBatch_);
+		player->setBlockGenerator(createBlockGenerator(players_.size()));
+		player->setBoardCorpusWriter(boardCorpusWriter_);
+		player->setReplayWriter(replayWriter_);
 		players_.push_back(player);
+		// The board is not created from the seed.
+		endReplay();
 	}
 
 	void restart() {
-		for (auto& player : players_) {
-			player->restart(randomBlockType(),
-				randomBlockType());
+		sendMoves();
+		nextSeed();
+		for (int i = 0; i < (int) players_.size(); ++i) {
+			BlockGenerator blockGenerator = createBlockGenerator(i);
+			BlockType current = blockGenerator.generateBlockType();
+			BlockType next = blockGenerator.generateBlockType();
+			players_[i]->restart(current, next);
+			players_[i]->setBlockGenerator(blockGenerator);
 		}
+		startReplay();
 
 		if (packetSender_.isActive()) {
 			sendConnectionStartBlock();
@@ -59,6 +132,9 @@ public:
 	}
 
 	void resizeBoard(int width, int height) {
+		// The boards keep the blocks from the old size.
+		sendMoves();
+		endReplay();
 		for (auto& player : players_) {
 			player->resizeBoard(width, height);
 		}
@@ -114,12 +190,31 @@ public:
 		accumulator_ += deltaTime;
 		while (accumulator_ >= timeStep_) {
 			accumulator_ -= timeStep_;
+			if (replayWriter_) {
+				replayWriter_->nextTick();
+			}
 			for (auto& player : players_) {
 				player->update(timeStep_);
 			}
+			sendMoves();
 		}
 	}
 
+	// Send the moves made by the players not yet sent. Must be called before other
+	// packets about the players are sent, to keep the order.
+	void sendMoves() {
+		moveBatch_.send(id_);
+	}
+
+	const MoveStatistics& getMoveStatistics() const {
+		return moveBatch_.getStatistics();
+	}
+
+	// The newest packet encoding known by all other connections.
+	void setEncodingVersion(int version) {
+		moveBatch_.setEncodingVersion(version);
+	}
+
 	net::Packet getClientInfo() const {
 		net::Packet packet;
 		packet << PacketType::CONNECTION_INFO;
@@ -137,6 +232,20 @@ public:
 		return packet;
 	}
 
+	// Must be sent after the CONNECTION_INFO, the level and points in it are only one
+	// byte.
+	net::Packet getEncodingInfo() const {
+		net::Packet packet;
+		packet << PacketType::CONNECTION_ENCODING;
+		packet << id_;
+		packet << ENCODING_VERSION;
+		for (auto& player : players_) {
+			packet << Varint(player->getLevel());
+			packet << Varint(player->getPoints());
+		}
+		return packet;
+	}
+
 	void setId(int id) {
 		id_ = id;
 		for (auto& player : players_) {
@@ -153,6 +262,40 @@ public:
 	}
 
 private:
+	// Start a new game with the seed for the next game.
+	void nextSeed() {
+		gameSeed_ = seed_;
+		seed_ = BlockGenerator::nextSeed(seed_);
+		rowGenerator_.reset(createRowSeed());
+	}
+
+	// Not the same as the seeds of the players, i.e. the game seed plus the index.
+	std::uint64_t createRowSeed() const {
+		return ~gameSeed_;
+	}
+
+	// Each player gets its own sequence derived from the game seed.
+	BlockGenerator createBlockGenerator(int playerIndex) const {
+		return BlockGenerator(gameSeed_ + playerIndex, blockGeneratorMode_);
+	}
+
+	void startReplay() {
+		if (replayWriter_ && !players_.empty()) {
+			std::vector<std::uint64_t> seeds;
+			for (int i = 0; i < (int) players_.size(); ++i) {
+				seeds.push_back(gameSeed_ + i);
+			}
+			const TetrisBoard& board = players_.front()->getTetrisBoard();
+			replayWriter_->startGame(board.getRows(), board.getColumns(), blockGeneratorMode_, timeStep_, seeds);
+		}
+	}
+
+	void endReplay() {
+		if (replayWriter_) {
+			replayWriter_->endGame();
+		}
+	}
+
 	bool isMultiplayerGame() const {
 		return players_.size() > 1 && packetSender_.isActive();
 	}	
@@ -170,8 +313,15 @@ private:
 
 	std::vector<std::shared_ptr<LocalPlayer>> players_;
 	PacketSender& packetSender_;
+	MoveBatch moveBatch_; // One packet with the moves of all players for each tick.
 	
 	int id_;
+	std::uint64_t seed_;
+	std::uint64_t gameSeed_;
+	BlockGenerator::Mode blockGeneratorMode_;
+	BlockGenerator rowGenerator_; // The rows added to the players.
+	std::shared_ptr<BoardCorpusWriter> boardCorpusWriter_;
+	std::shared_ptr<ReplayWriter> replayWriter_;
 
 	// Fix timestep.
 	const double timeStep_;
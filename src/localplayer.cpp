@@ -5,9 +5,9 @@
 #include <functional>
 
 LocalPlayer::LocalPlayer(int connectionId, int playerId, int width, int height,
-	BlockType moving, BlockType next, const DevicePtr& device, PacketSender& sender) :
+	BlockType moving, BlockType next, const DevicePtr& device, MoveBatch& moveBatch) :
 	Player(playerId, width, height, moving, next),
-	sender_(sender),
+	moveBatch_(moveBatch),
 	leftHandler_(0.09, false),
 	rightHandler_(0.09, false),
 	rotateHandler_(0.0, true),
@@ -25,9 +25,9 @@ LocalPlayer::LocalPlayer(int connectionId, int playerId, int width, int height,
 }
 
 LocalPlayer::LocalPlayer(int connectionId, int playerId, int width, int height, const std::vector<BlockType>& board, int levelUpCounter, int points, int level,
-	Block current, BlockType next, const DevicePtr& device, PacketSender& sender) :
+	Block current, BlockType next, const DevicePtr& device, MoveBatch& moveBatch) :
 	Player(playerId, width, height, points, level, current, next, board),
-	sender_(sender),
+	moveBatch_(moveBatch),
 	leftHandler_(0.09, false),
 	rightHandler_(0.09, false),
 	rotateHandler_(0.0, true),
@@ -51,15 +51,16 @@ void LocalPlayer::endGame() {
 }
 
 void LocalPlayer::update(Move move) {
+	// Moves after the game is over do nothing, no need to record or send them.
+	const bool gameOver = tetrisBoard_.isGameOver();
+	if (replayWriter_ && !gameOver) {
+		// Before the move, rows added to other players by the move are recorded after it.
+		replayWriter_->addMove(getId(), move);
+	}
+	const BlockType next = tetrisBoard_.getNextBlockType();
 	tetrisBoard_.update(move);
-	if (sender_.isActive()) {
-		net::Packet packet;
-		packet << PacketType::PLAYER_MOVE;
-		packet << connectionId_;
-		packet << getId();
-		packet << move;
-		packet << tetrisBoard_.getNextBlockType();
-		sender_.sendToAll(packet);
+	if (!gameOver) {
+		moveBatch_.add(getId(), move, tetrisBoard_.getNextBlockType(), next != tetrisBoard_.getNextBlockType(), tetrisBoard_.getHash());
 	}
 }
 
@@ -79,7 +80,7 @@ void LocalPlayer::boardListener(GameEvent gameEvent, const TetrisBoard& board) {
 			break;
 		case GameEvent::CURRENT_BLOCK_UPDATED:
 			// Generate a new block for a local player.
-			tetrisBoard_.updateNextBlock(randomBlockType()); // The listener will be called again, but with GameEvent::NEXT_BLOCK_UPDATED.
+			tetrisBoard_.updateNextBlock(tetrisBoard_.getBlockGenerator().generateBlockType()); // The listener will be called again, but with GameEvent::NEXT_BLOCK_UPDATED.
 
 			leftHandler_.reset();
 			rightHandler_.reset();
@@ -97,6 +98,7 @@ void LocalPlayer::update(double deltaTime) {
 		// The time beetween each "gravity" move.
 		double downTime = 1.0 / getGravityDownSpeed();
 		gravityMove_.setWaitingTime(downTime);
+		device_->setGravityInterval(downTime);
 
 		gravityMove_.update(deltaTime, true);
 		if (gravityMove_.doAction()) {
@@ -147,5 +149,8 @@ void LocalPlayer::resizeBoard(int width, int height) {
 }
 
 void LocalPlayer::addExternalRows(const std::vector<BlockType>& blockTypes) {
+	if (replayWriter_) {
+		replayWriter_->addRows(getId(), blockTypes);
+	}
 	tetrisBoard_.addRows(blockTypes);
 }
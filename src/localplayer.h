@@ -3,8 +3,10 @@
 
 #include "player.h"
 #include "tetrisboard.h"
+#include "replay.h"
 #include "actionhandler.h"
 #include "device.h"
+#include "movebatch.h"
 
 #include "protocol.h"
 
@@ -14,10 +16,10 @@
 class LocalPlayer : public Player {
 public:
 	LocalPlayer(int connectionId, int playerId, int width, int height,
-		BlockType moving, BlockType next, const DevicePtr& device, PacketSender& sender);
+		BlockType moving, BlockType next, const DevicePtr& device, MoveBatch& moveBatch);
 
 	LocalPlayer(int connectionId, int playerId, int width, int height, const std::vector<BlockType>& board, int levelUpCounter, int points, int level,
-		Block current, BlockType next, const DevicePtr& device, PacketSender& sender);
+		Block current, BlockType next, const DevicePtr& device, MoveBatch& moveBatch);
 
 	// @Player
     void update(double deltaTime) override;
@@ -28,6 +30,21 @@ public:
 
 	void restart(BlockType current, BlockType next);
 
+	// The generator for the next blocks, i.e. after the current and next block.
+	void setBlockGenerator(const BlockGenerator& blockGenerator) {
+		tetrisBoard_.setBlockGenerator(blockGenerator);
+	}
+
+	// Save the positions of the board to the corpus, null to stop saving.
+	void setBoardCorpusWriter(const std::shared_ptr<BoardCorpusWriter>& boardCorpusWriter) {
+		tetrisBoard_.setBoardCorpusWriter(boardCorpusWriter);
+	}
+
+	// Record the moves of the player, null to stop recording.
+	void setReplayWriter(const std::shared_ptr<ReplayWriter>& replayWriter) {
+		replayWriter_ = replayWriter;
+	}
+
 	void resizeBoard(int width, int height);
 
 	int getLevelUpCounter() const {
@@ -66,10 +83,11 @@ private:
     // Objects controlling how the moving block is moved.
 	ActionHandler gravityMove_, downHandler_, leftHandler_, rightHandler_, rotateHandler_, downGroundHandler_;
 	DevicePtr device_;
-	PacketSender& sender_;
+	MoveBatch& moveBatch_;
 	int levelUpCounter_;
 	int connectionId_;
 	double watingTime_;
+	std::shared_ptr<ReplayWriter> replayWriter_;
 };
 
 #endif // LOCALPLAYER_H
@@ -0,0 +1,169 @@
+#include "movebatch.h"
+
+#include <algorithm>
+
+namespace {
+
+	// Packet::operator<<(int) sends one byte.
+	const int MAX_COUNT = 127;
+
+	// Set in the move byte when the number of times follows.
+	const char COUNT_FLAG = 0x40;
+
+	// The size of a packet holding a single move.
+	int calculateUnbatchedSize() {
+		net::Packet packet;
+		packet << PacketType::PLAYER_MOVE;
+		packet << SERVER_CONNECTION_ID;
+		packet << 0;
+		packet << Move::DOWN;
+		packet << BlockType::I;
+		return packet.getSize();
+	}
+
+} // Anonymous namespace.
+
+MoveBatch::MoveBatch(PacketSender& sender) : sender_(sender), unbatchedSize_(calculateUnbatchedSize()), encodingVersion_(0) {
+}
+
+void MoveBatch::add(int playerId, Move move, BlockType next, bool nextChanged, std::uint64_t hash) {
+	if (!sender_.isActive()) {
+		return;
+	}
+	++statistics_.moves_;
+	statistics_.unbatchedBytes_ += unbatchedSize_;
+
+	auto it = std::find_if(hashes_.begin(), hashes_.end(), [playerId](const PlayerHash& playerHash) {
+		return playerHash.playerId_ == playerId;
+	});
+	if (it != hashes_.end()) {
+		it->hash_ = hash;
+		it->nextChanged_ = it->nextChanged_ || nextChanged;
+	} else {
+		hashes_.push_back({playerId, hash, nextChanged});
+	}
+
+	if (!runs_.empty()) {
+		MoveRun& last = runs_.back();
+		if (last.playerId_ == playerId && last.move_ == move && last.next_ == next && last.count_ < MAX_COUNT) {
+			++last.count_;
+			return;
+		}
+	}
+	runs_.push_back({playerId, move, 1, nextChanged, next});
+}
+
+void MoveBatch::send(int connectionId) {
+	if (runs_.empty()) {
+		return;
+	}
+	if (encodingVersion_ < BATCH_ENCODING_VERSION) {
+		for (const MoveRun& run : runs_) {
+			for (int i = 0; i < run.count_; ++i) {
+				net::Packet packet;
+				packet << PacketType::PLAYER_MOVE;
+				packet << connectionId;
+				packet << run.playerId_;
+				packet << run.move_;
+				packet << run.next_;
+				sendPacket(packet);
+			}
+		}
+	} else if (encodingVersion_ < COMPACT_ENCODING_VERSION) {
+		net::Packet packet;
+		packet << PacketType::PLAYER_MOVE;
+		packet << connectionId;
+		for (const MoveRun& run : runs_) {
+			packet << run.playerId_;
+			if (run.count_ > 1) {
+				packet << (char) ((char) run.move_ | COUNT_FLAG);
+				packet << run.count_;
+			} else {
+				packet << run.move_;
+			}
+			packet << run.next_;
+		}
+		sendPacket(packet);
+	} else {
+		net::Packet packet;
+		packet << PacketType::PLAYER_MOVE_COMPACT;
+		packet << connectionId;
+		packet << Varint((int) runs_.size());
+		BitWriter writer(packet);
+		for (const MoveRun& run : runs_) {
+			writer.writeVarint(run.playerId_, 3);
+			writer.write((int) run.move_, 3);
+			writer.write(run.count_ > 1, 1);
+			if (run.count_ > 1) {
+				writer.writeVarint(run.count_ - 2, 3);
+			}
+			writer.write(run.nextChanged_, 1);
+			if (run.nextChanged_) {
+				writer.write((int) run.next_, 3);
+			}
+		}
+		writer.flush();
+		for (const PlayerHash& playerHash : hashes_) {
+			if (playerHash.nextChanged_) {
+				packet << (char) (playerHash.hash_ & 0xff);
+			}
+		}
+		sendPacket(packet);
+	}
+	runs_.clear();
+	hashes_.clear();
+}
+
+void MoveBatch::sendPacket(const net::Packet& packet) {
+	++statistics_.packets_;
+	statistics_.bytes_ += packet.getSize();
+	sender_.sendToAll(packet);
+}
+
+MoveReader::MoveReader(net::Packet& packet, bool compact) : packet_(packet), bitReader_(packet), compact_(compact), runsLeft_(0) {
+	if (compact_) {
+		Varint runs;
+		packet_ >> runs;
+		runsLeft_ = runs.value_;
+	}
+}
+
+bool MoveReader::read(MoveRun& run) {
+	if (compact_) {
+		if (runsLeft_ <= 0) {
+			return false;
+		}
+		--runsLeft_;
+		run.playerId_ = bitReader_.readVarint(3);
+		run.move_ = (Move) bitReader_.read(3);
+		run.count_ = bitReader_.read(1) != 0 ? bitReader_.readVarint(3) + 2 : 1;
+		run.nextChanged_ = bitReader_.read(1) != 0;
+		run.next_ = run.nextChanged_ ? (BlockType) bitReader_.read(3) : BlockType::EMPTY;
+		return true;
+	}
+
+	if (packet_.dataLeftToRead() <= 0) {
+		return false;
+	}
+	packet_ >> run.playerId_;
+	char data;
+	packet_ >> data;
+	run.move_ = (Move) (data & ~COUNT_FLAG);
+	run.count_ = 1;
+	if (data & COUNT_FLAG) {
+		packet_ >> run.count_;
+	}
+	run.nextChanged_ = true;
+	packet_ >> run.next_;
+	return true;
+}
+
+bool MoveReader::readHash(int& hash) {
+	if (!compact_ || packet_.dataLeftToRead() <= 0) {
+		return false;
+	}
+	char data;
+	packet_ >> data;
+	hash = (unsigned char) data;
+	return true;
+}
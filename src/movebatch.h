@@ -0,0 +1,116 @@
+#ifndef MOVEBATCH_H
+#define MOVEBATCH_H
+
+#include "protocol.h"
+
+#include <cstdint>
+#include <vector>
+
+// Counts the moves sent, and what sending each move in its own packet would cost.
+class MoveStatistics {
+public:
+	MoveStatistics() : moves_(0), packets_(0), bytes_(0), unbatchedBytes_(0) {
+	}
+
+	std::int64_t getPacketsSaved() const {
+		return moves_ - packets_;
+	}
+
+	std::int64_t getBytesSaved() const {
+		return unbatchedBytes_ - bytes_;
+	}
+
+	std::int64_t moves_;
+	std::int64_t packets_;
+	std::int64_t bytes_;
+	std::int64_t unbatchedBytes_;
+};
+
+// Moves repeated by a player, and the next block after them.
+struct MoveRun {
+	int playerId_;
+	Move move_;
+	int count_;
+	bool nextChanged_; // False if the moves did not change the next block.
+	BlockType next_;
+};
+
+// Collects the moves of all local players into one packet for each tick. A move
+// repeated by the same player is sent once with the number of times, as long as the
+// next block stays the same. Below BATCH_ENCODING_VERSION each move is sent in its
+// own PLAYER_MOVE instead.
+//
+// PLAYER_MOVE: connection id, then for each run of moves: player id, move, number of
+// times (only if more than one, flagged in the move byte) and the next block. A
+// single move is the same as before the batching.
+// PLAYER_MOVE_COMPACT: connection id, number of runs as a varint, then the runs bit
+// packed: player id (varint, 3 bit groups), move (3 bits), a bit set if followed by
+// the number of times minus two (varint, 3 bit groups), and a bit set if followed by
+// the next block (3 bits). Then, for each player with a changed next block in the
+// runs, i.e. a block was added to the board, the low byte of the board hash after the
+// moves, see RawTetrisBoard::getHash. In the order of the first run of each player.
+class MoveBatch {
+public:
+	explicit MoveBatch(PacketSender& sender);
+
+	MoveBatch(const MoveBatch&) = delete;
+	MoveBatch& operator=(const MoveBatch&) = delete;
+
+	// The newest packet encoding known by all connections.
+	void setEncodingVersion(int version) {
+		encodingVersion_ = version;
+	}
+
+	int getEncodingVersion() const {
+		return encodingVersion_;
+	}
+
+	// Add the move, made by the player, to the next packet. The hash is of the board
+	// after the move. Ignored if there is no one to send to.
+	void add(int playerId, Move move, BlockType next, bool nextChanged, std::uint64_t hash);
+
+	// Send all moves added since the last call, nothing is sent if there are none.
+	void send(int connectionId);
+
+	const MoveStatistics& getStatistics() const {
+		return statistics_;
+	}
+
+private:
+	void sendPacket(const net::Packet& packet);
+
+	struct PlayerHash {
+		int playerId_;
+		std::uint64_t hash_;
+		bool nextChanged_;
+	};
+
+	PacketSender& sender_;
+	std::vector<MoveRun> runs_;
+	std::vector<PlayerHash> hashes_; // The newest for each player in the runs.
+	MoveStatistics statistics_;
+	const int unbatchedSize_;
+	int encodingVersion_;
+};
+
+// Reads the runs of moves in a PLAYER_MOVE or PLAYER_MOVE_COMPACT packet.
+class MoveReader {
+public:
+	// The packet must be read up to and including the connection id.
+	MoveReader(net::Packet& packet, bool compact);
+
+	// Return false if there are no more runs.
+	bool read(MoveRun& run);
+
+	// Return false if there are no more hashes, i.e. always for PLAYER_MOVE. Must be
+	// called after all runs are read.
+	bool readHash(int& hash);
+
+private:
+	net::Packet& packet_;
+	BitReader bitReader_;
+	const bool compact_;
+	int runsLeft_;
+};
+
+#endif // MOVEBATCH_H
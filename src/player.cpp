@@ -14,3 +14,18 @@ Player::Player(int id, int width, int height, int points, int level, Block curre
 mw::signals::Connection Player::addGameEventListener(const std::function<void(GameEvent, const TetrisBoard&)>& callback) {
 	return tetrisBoard_.addGameEventListener(callback);
 }
+
+void Player::createSnapshot(PlayerSnapshot& snapshot) const {
+	snapshot.id_ = id_;
+	snapshot.name_ = name_;
+	snapshot.ai_ = isAi();
+	snapshot.level_ = level_;
+	snapshot.points_ = points_;
+	snapshot.clearedRows_ = getClearedRows();
+	snapshot.rows_ = tetrisBoard_.getRows();
+	snapshot.columns_ = tetrisBoard_.getColumns();
+	snapshot.squares_ = tetrisBoard_.getBoardVector();
+	snapshot.current_ = tetrisBoard_.getBlock();
+	snapshot.next_ = tetrisBoard_.getNextBlockType();
+	snapshot.gameOver_ = tetrisBoard_.isGameOver();
+}
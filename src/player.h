@@ -2,6 +2,7 @@
 #define PLAYER_H
 
 #include "tetrisboard.h"
+#include "gamesnapshot.h"
 
 #include <mw/signal.h>
 
@@ -57,6 +58,9 @@ public:
 
 	virtual bool isAi() const = 0;
 
+	// Copy the state of the player, the vectors in the snapshot are reused.
+	void createSnapshot(PlayerSnapshot& snapshot) const;
+
 	mw::signals::Connection addGameEventListener(const std::function<void(GameEvent, const TetrisBoard&)>& callback);
 
 protected:
@@ -120,3 +120,90 @@ net::Packet& operator>>(net::Packet& packet, std::string& text) {
 	}
 	return packet;
 }
+
+
+net::Packet& operator<<(net::Packet& packet, Varint number) {
+	unsigned int value = number.value_;
+	while (value >= 0x80) {
+		packet << (char) ((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	packet << (char) value;
+	return packet;
+}
+
+net::Packet& operator>>(net::Packet& packet, Varint& number) {
+	unsigned int value = 0;
+	int shift = 0;
+	char data = 0;
+	do {
+		packet >> data;
+		value |= (unsigned int) (data & 0x7f) << shift;
+		shift += 7;
+	} while ((data & 0x80) != 0 && shift < 32);
+	number.value_ = (int) value;
+	return packet;
+}
+
+
+BitWriter::BitWriter(net::Packet& packet) : packet_(packet), buffer_(0), size_(0) {
+}
+
+void BitWriter::write(int value, int bits) {
+	buffer_ |= ((unsigned int) value & ((1u << bits) - 1)) << size_;
+	size_ += bits;
+	while (size_ >= 8) {
+		packet_ << (char) (buffer_ & 0xff);
+		buffer_ >>= 8;
+		size_ -= 8;
+	}
+}
+
+void BitWriter::writeVarint(int value, int groupBits) {
+	unsigned int left = value;
+	const unsigned int limit = 1u << groupBits;
+	while (left >= limit) {
+		write(left & (limit - 1), groupBits);
+		write(1, 1);
+		left >>= groupBits;
+	}
+	write(left, groupBits);
+	write(0, 1);
+}
+
+void BitWriter::flush() {
+	if (size_ > 0) {
+		packet_ << (char) (buffer_ & 0xff);
+		buffer_ = 0;
+		size_ = 0;
+	}
+}
+
+
+BitReader::BitReader(net::Packet& packet) : packet_(packet), buffer_(0), size_(0) {
+}
+
+int BitReader::read(int bits) {
+	while (size_ < bits) {
+		char data = 0;
+		if (packet_.dataLeftToRead() > 0) {
+			packet_ >> data;
+		}
+		buffer_ |= (unsigned int) (unsigned char) data << size_;
+		size_ += 8;
+	}
+	int value = buffer_ & ((1u << bits) - 1);
+	buffer_ >>= bits;
+	size_ -= bits;
+	return value;
+}
+
+int BitReader::readVarint(int groupBits) {
+	unsigned int value = 0;
+	int shift = 0;
+	do {
+		value |= (unsigned int) read(groupBits) << shift;
+		shift += groupBits;
+	} while (read(1) != 0 && shift < 32);
+	return (int) value;
+}
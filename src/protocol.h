@@ -17,16 +17,41 @@ enum class PacketType {
 	CONNECTION_INFO,       // The info about players and tetrisboard conditions.
 	CONNECTION_DISCONNECT, // The connection with the id was disconnected.
 	CONNECTION_START_BLOCK,// The start blocks for all players for a connection.
-	PLAYER_MOVE,           // A move to update the tetrisboard for a player.
+	PLAYER_MOVE,           // The moves of the players in a connection during a tick, see MoveBatch.
 	PLAYER_TETRIS,         // Add rows to a player.
 	PLAYER_NAME,           // The name for a player.
 	PLAYER_LEVEL,          // The level for a player.
-	PLAYER_POINTS          // The point for a player.
+	PLAYER_POINTS,         // The point for a player.
+	PLAYER_MOVE_COMPACT,   // The same as PLAYER_MOVE, bit packed.
+	PLAYER_BOARD,          // A snapshot of the board for a player, see BoardSync.
+	PLAYER_BOARD_ACK,      // The snapshot applied to the board for a player in another connection.
+	CONNECTION_ENCODING    // The newest encoding known by the connection and the player points, sent after CONNECTION_INFO.
 };
 
 static const int SERVER_CONNECTION_ID = 0;
 static const int UNDEFINED_CONNECTION_ID = -1;
 
+// The newest packet encoding known, sent in CONNECTION_ENCODING. A connection only
+// sends encodings known by all other connections. CONNECTION_INFO keeps the format
+// of the connections from before the versions, which ignore the unknown
+// CONNECTION_ENCODING and are seen as version 0, i.e. one move in each PLAYER_MOVE.
+static const int ENCODING_VERSION = 3;
+static const int BATCH_ENCODING_VERSION = 1; // PacketType::PLAYER_MOVE with runs of moves.
+static const int COMPACT_ENCODING_VERSION = 2; // PacketType::PLAYER_MOVE_COMPACT.
+static const int SNAPSHOT_ENCODING_VERSION = 3; // PacketType::PLAYER_BOARD and PLAYER_BOARD_ACK.
+
+// A non-negative number written with 7 bits in each byte, the high bit set if
+// more bytes follow, i.e. small numbers take one byte.
+struct Varint {
+	Varint() : value_(0) {
+	}
+
+	explicit Varint(int value) : value_(value) {
+	}
+
+	int value_;
+};
+
 net::Packet& operator<<(net::Packet& packet1, const net::Packet& packet2);
 
 net::Packet& operator<<(net::Packet& packet, Input input);
@@ -63,6 +88,48 @@ net::Packet& operator<<(net::Packet& packet, const std::string& text);
 
 net::Packet& operator>>(net::Packet& packet, std::string& text);
 
+
+net::Packet& operator<<(net::Packet& packet, Varint number);
+
+net::Packet& operator>>(net::Packet& packet, Varint& number);
+
+// Packs values of a few bits each into the bytes of a packet. Nothing else may be
+// written to the packet until flush is called.
+class BitWriter {
+public:
+	explicit BitWriter(net::Packet& packet);
+
+	void write(int value, int bits);
+
+	// Written in groups of bits, each group followed by a bit set if more groups
+	// follow.
+	void writeVarint(int value, int groupBits);
+
+	// Write the bits not yet written, the last byte is filled with zeros.
+	void flush();
+
+private:
+	net::Packet& packet_;
+	unsigned int buffer_;
+	int size_;
+};
+
+// Reads values written by BitWriter.
+class BitReader {
+public:
+	explicit BitReader(net::Packet& packet);
+
+	// Return zeros after the end of the packet.
+	int read(int bits);
+
+	int readVarint(int groupBits);
+
+private:
+	net::Packet& packet_;
+	unsigned int buffer_;
+	int size_;
+};
+
 class PacketSender {
 public:
 	virtual void sendToAll(const net::Packet& packet) const = 0;
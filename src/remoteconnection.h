@@ -2,19 +2,21 @@
 #define REMOTECONNECTION_H
 
 #include "remoteplayer.h"
+#include "movebatch.h"
 #include "protocol.h"
 #include "tetrisparameters.h"
 #include "connection.h"
 
 #include <net/connection.h>
 
+#include <algorithm>
 #include <vector>
 
 // Hold information about players from a remote connection.
 class RemoteConnection : public Connection {
 public:
 	RemoteConnection(int id, const net::ConnectionPtr& connection) : 
-		connection_(connection), id_(id), width_(TETRIS_WIDTH), height_(TETRIS_HEIGHT) {
+		connection_(connection), id_(id), width_(TETRIS_WIDTH), height_(TETRIS_HEIGHT), encodingVersion_(0) {
 
 	}
 
@@ -93,12 +95,61 @@ public:
 					player->setName(name);
 					player->setLevel(level);
 					player->setPoints(points);
-					player->setPoints(points);
 					players_.push_back(player);
 				}
 				break;
+			case PacketType::CONNECTION_ENCODING:
+				packet >> encodingVersion_;
+				for (auto& player : players_) {
+					if (packet.dataLeftToRead() <= 0) {
+						break;
+					}
+					Varint level;
+					packet >> level;
+					Varint points;
+					packet >> points;
+					player->setLevel(level.value_);
+					player->setPoints(points.value_);
+				}
+				break;
 			case PacketType::PLAYER_MOVE:
 				// Fall through!
+			case PacketType::PLAYER_MOVE_COMPACT:
+			{
+				MoveReader reader(packet, type == PacketType::PLAYER_MOVE_COMPACT);
+				MoveRun run;
+				movedPlayers_.clear();
+				while (reader.read(run)) {
+					if (run.playerId_ >= 0 && run.playerId_ < (int) players_.size()) {
+						auto& player = players_[run.playerId_];
+						for (int i = 0; i < run.count_; ++i) {
+							player->update(run.move_, run.nextChanged_ ? run.next_ : player->getTetrisBoard().getNextBlockType());
+						}
+						auto it = std::find_if(movedPlayers_.begin(), movedPlayers_.end(), [&run](const std::pair<int, bool>& moved) {
+							return moved.first == run.playerId_;
+						});
+						if (it != movedPlayers_.end()) {
+							it->second = it->second || run.nextChanged_;
+						} else {
+							movedPlayers_.emplace_back(run.playerId_, run.nextChanged_);
+						}
+					} else {
+						// Protocol error.
+						throw 1;
+					}
+				}
+				// The boards with an added block must be the same as in the remote connection.
+				for (const auto& moved : movedPlayers_) {
+					int hash;
+					if (moved.second && reader.readHash(hash)) {
+						const TetrisBoard& board = players_[moved.first]->getTetrisBoard();
+						if (!board.isGameOver() && (int) (board.getHash() & 0xff) != hash) {
+							desyncedPlayers_.push_back(moved.first);
+						}
+					}
+				}
+				break;
+			}
 			case PacketType::PLAYER_TETRIS:
 				// Fall through!
 			case PacketType::PLAYER_NAME:
@@ -120,6 +171,21 @@ public:
 		}
 	}
 
+	// The newest packet encoding known by the connection.
+	int getEncodingVersion() const {
+		return encodingVersion_;
+	}
+
+	// The players with a board not the same as in the remote connection, found by the
+	// board hashes in the moves received since the last call to clearDesyncedPlayers.
+	const std::vector<int>& getDesyncedPlayers() const {
+		return desyncedPlayers_;
+	}
+
+	void clearDesyncedPlayers() {
+		desyncedPlayers_.clear();
+	}
+
 	void resizeBoard(int width, int height) {
 		width_ = width;
 		height_ = height;
@@ -154,12 +220,28 @@ public:
 		return packet;
 	}
 
+	// Must be sent after the CONNECTION_INFO.
+	net::Packet getEncodingInfo() const {
+		net::Packet packet;
+		packet << PacketType::CONNECTION_ENCODING;
+		packet << id_;
+		packet << encodingVersion_;
+		for (auto& player : players_) {
+			packet << Varint(player->getLevel());
+			packet << Varint(player->getPoints());
+		}
+		return packet;
+	}
+
 private:
 	std::vector<std::shared_ptr<RemotePlayer>> players_;
+	std::vector<std::pair<int, bool>> movedPlayers_; // Player id and next block changed, reused for each move packet.
+	std::vector<int> desyncedPlayers_;
 	net::ConnectionPtr connection_;
 
 	const int id_;
 	int width_, height_;
+	int encodingVersion_;
 };
 
 #endif // REMOTECONNECTION_H
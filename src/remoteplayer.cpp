@@ -19,22 +19,13 @@ void RemotePlayer::receive(net::Packet& packet) {
 	int playerId; // Not used;
 	packet >> playerId;
 	switch (type) {
-		case PacketType::PLAYER_MOVE:
-		{
-			Move move;
-			packet >> move;
-			BlockType next;
-			packet >> next;
-			tetrisBoard_.update(move);
-			tetrisBoard_.updateNextBlock(next);
-			break;
-		}
 		case PacketType::PLAYER_TETRIS:
 		{
 			std::vector<BlockType> blockTypes;
 			while (packet.dataLeftToRead() > 0) {
 				BlockType type;
 				packet >> type;
+				blockTypes.push_back(type);
 			}
 			tetrisBoard_.addRows(blockTypes);
 			break;
@@ -51,6 +42,15 @@ void RemotePlayer::receive(net::Packet& packet) {
 	}
 }
 
+void RemotePlayer::update(Move move, BlockType next) {
+	tetrisBoard_.update(move);
+	tetrisBoard_.updateNextBlock(next);
+}
+
+void RemotePlayer::updateBoard(const std::vector<BlockType>& squares, const Block& current, BlockType next) {
+	tetrisBoard_.updateBoard(squares, current, next);
+}
+
 void RemotePlayer::resizeBoard(int width, int height) {
 	tetrisBoard_.updateRestart(height, width, tetrisBoard_.getBlockType(), tetrisBoard_.getNextBlockType());
 	level_ = 1;
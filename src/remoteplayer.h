@@ -18,6 +18,12 @@ public:
 
 	void receive(net::Packet& packet);
 
+	// Make the move, as made by the player in the remote connection.
+	void update(Move move, BlockType next);
+
+	// Replace the board with the board in a snapshot from the remote connection.
+	void updateBoard(const std::vector<BlockType>& squares, const Block& current, BlockType next);
+
 	void resizeBoard(int width, int height);
 
 	void restart(BlockType current, BlockType next);
@@ -0,0 +1,141 @@
+#include "roomserver.h"
+#include "tetrisparameters.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+	// Ticks of a room with packets received within the active time.
+	const std::chrono::microseconds ACTIVE_TICK(16667);
+	const std::chrono::milliseconds IDLE_TICK(100);
+	const std::chrono::seconds ACTIVE_TIME(1);
+
+	// Longest wait before new connections are accepted.
+	const std::chrono::milliseconds ACCEPT_INTERVAL(10);
+
+	void add(RoomStatistics& sum, const RoomStatistics& statistics) {
+		sum.packets_ += statistics.packets_;
+		sum.bytes_ += statistics.bytes_;
+		sum.protocolErrors_ += statistics.protocolErrors_;
+	}
+
+	void add(SyncStatistics& sum, const SyncStatistics& statistics) {
+		sum.snapshots_ += statistics.snapshots_;
+		sum.completeSnapshots_ += statistics.completeSnapshots_;
+		sum.bytes_ += statistics.bytes_;
+		sum.resyncs_ += statistics.resyncs_;
+		sum.desyncs_ += statistics.desyncs_;
+		sum.resyncRequests_ += statistics.resyncRequests_;
+	}
+
+} // Anonymous namespace.
+
+RoomServer::RoomServer(int connectionsPerRoom, int workers) :
+	network_(10),
+	threadPool_(workers),
+	connectionsPerRoom_(std::max(1, std::min(connectionsPerRoom, GameRoom::MAX_CONNECTIONS))),
+	lastRoomId_(0) {
+}
+
+RoomServer::~RoomServer() {
+	stop();
+}
+
+void RoomServer::start(int port) {
+	network_.startServer(port);
+	network_.setAcceptConnections(true);
+}
+
+void RoomServer::stop() {
+	for (const ScheduledRoom& room : rooms_) {
+		add(removedStatistics_, room.room_->getStatistics());
+		add(removedSyncStatistics_, room.room_->getSyncStatistics());
+	}
+	rooms_.clear();
+	network_.stop();
+}
+
+void RoomServer::update() {
+	Clock::time_point now = Clock::now();
+	acceptConnections(now);
+
+	dueRooms_.clear();
+	for (ScheduledRoom& room : rooms_) {
+		if (room.nextTick_ <= now) {
+			dueRooms_.push_back(&room);
+		}
+	}
+
+	threadPool_.parallelFor(dueRooms_.size(), [&](int index) {
+		ScheduledRoom& room = *dueRooms_[index];
+		if (room.room_->update() > 0) {
+			room.lastActive_ = now;
+		}
+		Clock::duration interval = now - room.lastActive_ < ACTIVE_TIME ? ACTIVE_TICK : IDLE_TICK;
+		room.nextTick_ += interval;
+		if (room.nextTick_ <= now) {
+			// Too far behind, skip the missed ticks.
+			room.nextTick_ = now + interval;
+		}
+	});
+
+	removeEmptyRooms();
+
+	Clock::time_point nextTick = now + ACCEPT_INTERVAL;
+	for (const ScheduledRoom& room : rooms_) {
+		nextTick = std::min(nextTick, room.nextTick_);
+	}
+	std::this_thread::sleep_until(nextTick);
+}
+
+void RoomServer::acceptConnections(Clock::time_point now) {
+	while (auto connection = network_.pollConnection()) {
+		auto it = std::find_if(rooms_.begin(), rooms_.end(), [&](const ScheduledRoom& room) {
+			return room.room_->getNbrOfConnections() < connectionsPerRoom_;
+		});
+		if (it == rooms_.end()) {
+			rooms_.push_back(ScheduledRoom{std::make_unique<GameRoom>(++lastRoomId_, TETRIS_WIDTH, TETRIS_HEIGHT), now, now});
+			it = rooms_.end() - 1;
+		}
+		it->room_->addConnection(connection);
+		it->nextTick_ = now;
+		it->lastActive_ = now;
+	}
+}
+
+void RoomServer::removeEmptyRooms() {
+	auto it = std::remove_if(rooms_.begin(), rooms_.end(), [&](const ScheduledRoom& room) {
+		if (room.room_->getNbrOfConnections() > 0) {
+			return false;
+		}
+		add(removedStatistics_, room.room_->getStatistics());
+		add(removedSyncStatistics_, room.room_->getSyncStatistics());
+		return true;
+	});
+	rooms_.erase(it, rooms_.end());
+}
+
+int RoomServer::getNbrOfConnections() const {
+	int connections = 0;
+	for (const ScheduledRoom& room : rooms_) {
+		connections += room.room_->getNbrOfConnections();
+	}
+	return connections;
+}
+
+RoomStatistics RoomServer::getStatistics() const {
+	RoomStatistics statistics = removedStatistics_;
+	for (const ScheduledRoom& room : rooms_) {
+		add(statistics, room.room_->getStatistics());
+	}
+	return statistics;
+}
+
+SyncStatistics RoomServer::getSyncStatistics() const {
+	SyncStatistics statistics = removedSyncStatistics_;
+	for (const ScheduledRoom& room : rooms_) {
+		add(statistics, room.room_->getSyncStatistics());
+	}
+	return statistics;
+}
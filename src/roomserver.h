@@ -0,0 +1,73 @@
+#ifndef ROOMSERVER_H
+#define ROOMSERVER_H
+
+#include "gameroom.h"
+
+#include <threadpool.h>
+
+#include <net/network.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Hosts many game rooms in one process, without a window. New connections fill the
+// oldest room with a free place, or a new room. Each room is updated on its own tick,
+// often while packets arrive and seldom when idle, and the rooms due are updated in
+// parallel by the thread pool. A room is only used by one thread at a time.
+class RoomServer {
+public:
+	// With no workers all rooms are updated by the thread calling update. The
+	// connections per room are limited to GameRoom::MAX_CONNECTIONS.
+	RoomServer(int connectionsPerRoom, int workers);
+
+	~RoomServer();
+
+	RoomServer(const RoomServer&) = delete;
+	RoomServer& operator=(const RoomServer&) = delete;
+
+	void start(int port);
+
+	// Disconnect all connections and remove all rooms.
+	void stop();
+
+	// Accept the new connections and update the rooms due. Waits until the next room
+	// is due, but not longer than the interval between accepting new connections.
+	void update();
+
+	int getNbrOfRooms() const {
+		return rooms_.size();
+	}
+
+	int getNbrOfConnections() const;
+
+	// The sum over all rooms, also the removed rooms.
+	RoomStatistics getStatistics() const;
+
+	// The sum over all rooms, also the removed rooms.
+	SyncStatistics getSyncStatistics() const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct ScheduledRoom {
+		std::unique_ptr<GameRoom> room_;
+		Clock::time_point nextTick_;
+		Clock::time_point lastActive_; // Last packet received.
+	};
+
+	void acceptConnections(Clock::time_point now);
+
+	void removeEmptyRooms();
+
+	net::Network network_;
+	ThreadPool threadPool_;
+	std::vector<ScheduledRoom> rooms_;
+	std::vector<ScheduledRoom*> dueRooms_; // Reused each update.
+	RoomStatistics removedStatistics_;
+	SyncStatistics removedSyncStatistics_;
+	const int connectionsPerRoom_;
+	int lastRoomId_;
+};
+
+#endif // ROOMSERVER_H
@@ -0,0 +1,117 @@
+#include "simulationthread.h"
+#include "tetrisgame.h"
+
+#include <chrono>
+#include <condition_variable>
+
+namespace {
+
+	// Ticks later than this are skipped, to avoid spiral of death.
+	const std::chrono::milliseconds MAX_LAG(250);
+
+} // Anonymous namespace.
+
+SimulationThread::SimulationThread(TetrisGame& tetrisGame, double timeStep)
+	: tetrisGame_(tetrisGame), timeStep_(timeStep), running_(false), tick_(0) {
+}
+
+SimulationThread::~SimulationThread() {
+	stop();
+}
+
+void SimulationThread::start() {
+	if (!running_) {
+		running_ = true;
+		thread_ = std::thread(&SimulationThread::run, this);
+	}
+}
+
+void SimulationThread::stop() {
+	if (running_) {
+		running_ = false;
+		thread_.join();
+	}
+	callFunctions();
+}
+
+void SimulationThread::invoke(const std::function<void(TetrisGame&)>& function) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	functions_.push_back(function);
+}
+
+void SimulationThread::invokeAndWait(const std::function<void(TetrisGame&)>& function) {
+	if (!running_) {
+		callFunctions();
+		function(tetrisGame_);
+		return;
+	}
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool called = false;
+	invoke([&](TetrisGame& tetrisGame) {
+		function(tetrisGame);
+		std::lock_guard<std::mutex> lock(mutex);
+		called = true;
+		condition.notify_one();
+	});
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [&]() {
+		return called;
+	});
+}
+
+void SimulationThread::post(const std::function<void()>& function) {
+	std::lock_guard<std::mutex> lock(postedMutex_);
+	postedFunctions_.push_back(function);
+}
+
+void SimulationThread::callPostedFunctions() {
+	{
+		std::lock_guard<std::mutex> lock(postedMutex_);
+		calledPostedFunctions_.swap(postedFunctions_);
+	}
+	for (auto& function : calledPostedFunctions_) {
+		function();
+	}
+	calledPostedFunctions_.clear();
+}
+
+const GameSnapshot& SimulationThread::readSnapshot() {
+	snapshots_.update();
+	return snapshots_.getFront();
+}
+
+void SimulationThread::callFunctions() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		calledFunctions_.swap(functions_);
+	}
+	for (auto& function : calledFunctions_) {
+		function(tetrisGame_);
+	}
+	calledFunctions_.clear();
+}
+
+void SimulationThread::run() {
+	using Clock = std::chrono::steady_clock;
+	const auto timeStep = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeStep_));
+	auto nextTick = Clock::now();
+
+	while (running_) {
+		callFunctions();
+		tetrisGame_.update(timeStep_);
+
+		GameSnapshot& snapshot = snapshots_.getBack();
+		tetrisGame_.createSnapshot(snapshot);
+		snapshot.tick_ = ++tick_;
+		snapshots_.publish();
+
+		// Absolute times, i.e. the time to update does not add up.
+		nextTick += timeStep;
+		const auto now = Clock::now();
+		if (now - nextTick > MAX_LAG) {
+			nextTick = now;
+		}
+		std::this_thread::sleep_until(nextTick);
+	}
+}
@@ -0,0 +1,78 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+#include "gamesnapshot.h"
+#include "triplebuffer.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TetrisGame;
+
+// Updates the game in a dedicated thread at a fixed tick, i.e. the game and the
+// input do not depend on the frame rate or the time to draw. While running, the
+// game must only be changed through invoke and read through the snapshots.
+class SimulationThread {
+public:
+	SimulationThread(TetrisGame& tetrisGame, double timeStep = 1.0 / 60);
+	~SimulationThread();
+
+	SimulationThread(const SimulationThread&) = delete;
+	SimulationThread& operator=(const SimulationThread&) = delete;
+
+	void start();
+
+	// Wait for the current tick to finish and stop. Functions not yet called are
+	// called in the calling thread.
+	void stop();
+
+	bool isRunning() const {
+		return running_;
+	}
+
+	// Call the function in the simulation thread before the next tick.
+	void invoke(const std::function<void(TetrisGame&)>& function);
+
+	// Call the function in the simulation thread before the next tick, and wait for
+	// it to return. Must not be called from the simulation thread.
+	void invokeAndWait(const std::function<void(TetrisGame&)>& function);
+
+	// Call the function in the thread reading the snapshots, in the next call to
+	// callPostedFunctions. Used by the game callbacks, which are called in the
+	// simulation thread while running.
+	void post(const std::function<void()>& function);
+
+	// Call the posted functions, in the order posted. Only called by the thread
+	// reading the snapshots.
+	void callPostedFunctions();
+
+	// Return the snapshot from the latest tick. Only one thread may read snapshots.
+	const GameSnapshot& readSnapshot();
+
+	double getTimeStep() const {
+		return timeStep_;
+	}
+
+private:
+	void run();
+
+	void callFunctions();
+
+	TetrisGame& tetrisGame_;
+	const double timeStep_;
+	std::thread thread_;
+	std::atomic<bool> running_;
+	std::mutex mutex_;
+	std::vector<std::function<void(TetrisGame&)>> functions_;
+	std::vector<std::function<void(TetrisGame&)>> calledFunctions_; // Only used by the simulation thread.
+	std::mutex postedMutex_;
+	std::vector<std::function<void()>> postedFunctions_;
+	std::vector<std::function<void()>> calledPostedFunctions_; // Only used by the reader.
+	TripleBuffer<GameSnapshot> snapshots_;
+	int tick_;
+};
+
+#endif // SIMULATIONTHREAD_H
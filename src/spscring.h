@@ -0,0 +1,64 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <array>
+#include <atomic>
+
+// A bounded queue from one writer thread to one reader thread without locks,
+// neither side waits for the other. Push fails when the queue is full, i.e. the
+// writer decides what to do with a value the reader is too slow to take.
+// The capacity N must be a power of two.
+template <class T, int N>
+class SpscRing {
+public:
+	static_assert(N > 0 && (N & (N - 1)) == 0, "The capacity must be a power of two");
+
+	SpscRing() : head_(0), tail_(0) {
+	}
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	// Add the value last in the queue, return false if full. Only used by the writer.
+	bool push(const T& value) {
+		const unsigned int tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_.load(std::memory_order_acquire) == N) {
+			return false;
+		}
+		buffer_[tail & MASK] = value;
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// The number of values possible to push without failing, only used by the
+	// writer. The reader may make room for more in the meantime.
+	int getFreeSpace() const {
+		return N - (int) (tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire));
+	}
+
+	// Move the first value in the queue to the argument, return false if empty.
+	// Only used by the reader.
+	bool pop(T& value) {
+		const unsigned int head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire)) {
+			return false;
+		}
+		value = buffer_[head & MASK];
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	static int getCapacity() {
+		return N;
+	}
+
+private:
+	static const unsigned int MASK = N - 1;
+
+	std::array<T, N> buffer_;
+	std::atomic<unsigned int> head_; // Changed by the reader.
+	char padding_[64];               // Keep the indexes on different cache lines.
+	std::atomic<unsigned int> tail_; // Changed by the writer.
+};
+
+#endif // SPSCRING_H
@@ -100,8 +100,45 @@ namespace mw { // Must use the namespace color origin from.
 
 }
 
+void from_json(const json& j, Ai::SearchMode& searchMode) {
+	std::string name = j.get<std::string>();
+	if (name == "exhaustive") {
+		searchMode = Ai::SearchMode::EXHAUSTIVE;
+	} else if (name == "beam") {
+		searchMode = Ai::SearchMode::BEAM;
+	} else if (name == "expectimax") {
+		searchMode = Ai::SearchMode::EXPECTIMAX;
+	} else {
+		throw std::runtime_error("Search mode invalid: " + name);
+	}
+}
+
+void from_json(const json& j, BlockGenerator::Mode& mode) {
+	std::string name = j.get<std::string>();
+	if (name == "uniform") {
+		mode = BlockGenerator::Mode::UNIFORM;
+	} else if (name == "bag") {
+		mode = BlockGenerator::Mode::BAG;
+	} else {
+		throw std::runtime_error("Block generator invalid: " + name);
+	}
+}
+
 void from_json(const json& j, Ai& ai) {
 	ai = Ai(j.at("name").get<std::string>(), j.at("valueFunction").get<std::string>());
+	// Optional search parameters.
+	if (j.count("search") > 0) {
+		ai.setSearchMode(j.at("search").get<Ai::SearchMode>());
+	}
+	if (j.count("beamWidth") > 0) {
+		ai.setBeamWidth(j.at("beamWidth").get<int>());
+	}
+	if (j.count("timeBudget") > 0) {
+		ai.setTimeBudget(j.at("timeBudget").get<int>());
+	}
+	if (j.count("depth") > 0) {
+		ai.setDepth(j.at("depth").get<int>());
+	}
 }
 
 void from_json(const json& j, BlockType& blockType) {
@@ -402,6 +439,26 @@ std::vector<Ai> TetrisData::getAiVector() {
 	return ais;
 }
 
+int TetrisData::getAiWorkers() const {
+	return jsonObject_["aiWorkers"].get<int>();
+}
+
+int TetrisData::getAiDepth() const {
+	return jsonObject_["aiDepth"].get<int>();
+}
+
+BlockGenerator::Mode TetrisData::getBlockGeneratorMode() const {
+	return jsonObject_["blockGenerator"].get<BlockGenerator::Mode>();
+}
+
+std::string TetrisData::getBoardCorpusFile() const {
+	return jsonObject_["boardCorpus"].get<std::string>();
+}
+
+std::string TetrisData::getReplayFile() const {
+	return jsonObject_["replay"].get<std::string>();
+}
+
 std::vector<HighscoreRecord> TetrisData::getHighscoreRecordVector() {
 	return std::vector<HighscoreRecord>(jsonObject_["highscore"].begin(), jsonObject_["highscore"].end());
 }
@@ -2,6 +2,7 @@
 #define TETRISDATA_H
 
 #include "block.h"
+#include "blockgenerator.h"
 #include "ai.h"
 #include "tetrisgame.h"
 
@@ -123,6 +124,20 @@ public:
 	void setAi4Name(std::string name);
 
 	std::vector<Ai> getAiVector();
+
+	// The number of worker threads shared by all ai players.
+	int getAiWorkers() const;
+
+	// The number of blocks the ai players look ahead.
+	int getAiDepth() const;
+
+	BlockGenerator::Mode getBlockGeneratorMode() const;
+
+	// The file to save the board positions to, empty if not saved.
+	std::string getBoardCorpusFile() const;
+
+	// The file to record the games to, empty if not recorded.
+	std::string getReplayFile() const;
 	
 	std::vector<HighscoreRecord> getHighscoreRecordVector();
 	void setHighscoreRecordVector(const std::vector<HighscoreRecord>& highscoreVector);
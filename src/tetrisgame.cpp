@@ -21,7 +21,8 @@ TetrisGame::TetrisGame() :
 	network_(10),
 	countDownTime_(COUNT_DOWN_TIME),
 	timeLeftToStart_(-0.0),
-	wholeTimeLeft_(0) {
+	wholeTimeLeft_(0),
+	games_(0) {
 }
 
 TetrisGame::~TetrisGame() {
@@ -59,6 +60,16 @@ std::vector<PlayerData> TetrisGame::getPlayerData() const {
 	return playerData;
 }
 
+void TetrisGame::createSnapshot(GameSnapshot& snapshot) const {
+	snapshot.game_ = games_;
+	snapshot.paused_ = pause_;
+	snapshot.countDown_ = currentGameHasCountDown() && timeLeftToStart_ > 0 ? wholeTimeLeft_ : 0;
+	snapshot.players_.resize(players_.size());
+	for (std::size_t i = 0; i < players_.size(); ++i) {
+		players_[i]->createSnapshot(snapshot.players_[i]);
+	}
+}
+
 void TetrisGame::createLocalGame() {
 	if (status_ == WAITING_TO_CONNECT) {
 		status_ = LOCAL;
@@ -127,6 +138,8 @@ void TetrisGame::initGame() {
 
 	nbrOfPlayers_ = players.size();
 	nbrOfAlivePlayers_ = nbrOfPlayers_; // All players are living again.
+	players_ = players;
+	++games_;
 	InitGame initGame(players, remoteConnections);
 	eventHandler_(initGame);
 
@@ -161,6 +174,7 @@ void TetrisGame::closeGame() {
 	network_.stop();
 
 	sender_.disconnect();
+	boardSync_.clear();
 }
 
 bool TetrisGame::isPaused() const {
@@ -225,6 +239,7 @@ void TetrisGame::setPlayers(const std::vector<DevicePtr>& devices) {
 	if (status_ != Status::WAITING_TO_CONNECT) {
 		if (network_.isServer() || network_.isClient()) {
 			sender_.sendToAll(localConnection_.getClientInfo());
+			sender_.sendToAll(localConnection_.getEncodingInfo());
 		}
 
 		localConnection_.restart();
@@ -249,9 +264,11 @@ void TetrisGame::receiveAndSendNetworkData() {
 
 			// Send connection info of all connections to the new connection.
 			connection->send(localConnection_.getClientInfo());
+			connection->send(localConnection_.getEncodingInfo());
 			for (auto& remote : sender_) {
 				if (newRemote != remote) {
 					newRemote->send(remote->getClientInfo());
+					newRemote->send(remote->getEncodingInfo());
 				}
 			}
 
@@ -277,6 +294,7 @@ void TetrisGame::receiveAndSendNetworkData() {
 			if (connectionToServer) {
 				sender_.setServerConnection(connectionToServer);
 				sender_.sendToAll(localConnection_.getClientInfo());
+				sender_.sendToAll(localConnection_.getEncodingInfo());
 				NewConnection newConnection;
 				eventHandler_(newConnection);
 			}
@@ -292,6 +310,7 @@ void TetrisGame::receiveAndSendNetworkData() {
 void TetrisGame::update(double deltaTime) {
 	if (status_ != Status::WAITING_TO_CONNECT) {
 		receiveAndSendNetworkData();
+		localConnection_.setEncodingVersion(sender_.getEncodingVersion());
 
 		if (!pause_) {
 			if (timeLeftToStart_ > 0) {
@@ -312,6 +331,14 @@ void TetrisGame::update(double deltaTime) {
 				localConnection_.updateGame(deltaTime);
 			}
 		}
+
+		if (sender_.getEncodingVersion() >= SNAPSHOT_ENCODING_VERSION) {
+			connectionIds_.clear();
+			for (auto& remote : sender_) {
+				connectionIds_.push_back(remote->getId());
+			}
+			boardSync_.update(deltaTime, localConnection_, sender_, connectionIds_);
+		}
 	}
 }
 
@@ -348,6 +375,7 @@ void TetrisGame::clientReceive(net::Packet& packet) {
 			break;
 		case PacketType::CONNECTION_DISCONNECT:
 			sender_.removeConnection(id);
+			boardSync_.removeConnection(id);
 			initGame();
 			break;
 		default:
@@ -387,6 +415,41 @@ void TetrisGame::remoteReceive(std::shared_ptr<RemoteConnection> remoteConnectio
 				player->addGameEventListener(std::bind(&TetrisGame::applyRulesForRemotePlayers, this, std::placeholders::_1, std::placeholders::_2, player));
 			}
 			break;
+		case PacketType::CONNECTION_ENCODING:
+			if (remoteConnection) {
+				remoteConnection->receive(packet);
+				if (remoteConnection->getEncodingVersion() >= SNAPSHOT_ENCODING_VERSION) {
+					// The boards may already be played on, e.g. when joining a started game.
+					boardSync_.requestBoards(*remoteConnection, localConnection_.getId(), sender_);
+				}
+			} else {
+				// Protocol error.
+				throw 1;
+			}
+			break;
+		case PacketType::PLAYER_BOARD:
+			if (remoteConnection) {
+				boardSync_.receiveBoard(*remoteConnection, packet, localConnection_.getId(), sender_);
+			} else {
+				// Protocol error.
+				throw 1;
+			}
+			break;
+		case PacketType::PLAYER_BOARD_ACK:
+			boardSync_.receiveAck(packet);
+			break;
+		case PacketType::PLAYER_MOVE_COMPACT:
+			if (remoteConnection) {
+				remoteConnection->receive(packet);
+				for (int playerId : remoteConnection->getDesyncedPlayers()) {
+					boardSync_.receiveDesync(*remoteConnection, playerId, localConnection_.getId(), sender_);
+				}
+				remoteConnection->clearDesyncedPlayers();
+			} else {
+				// Protocol error.
+				throw 1;
+			}
+			break;
 		case PacketType::CONNECTION_START_BLOCK:
 			initGame();
 			// Fall through.
@@ -423,17 +486,19 @@ void TetrisGame::applyRulesForLocalPlayers(GameEvent gameEvent, const TetrisBoar
 					if (player->getId() != local->getId()) {
 						std::vector<BlockType> blockTypes;
 						for (int i = 0; i < rows; ++i) {
-							std::vector<BlockType> tmp = generateRow(local->getTetrisBoard(), 0.79);
+							std::vector<BlockType> tmp = localConnection_.generateRow(local->getTetrisBoard(), 0.79);
 							blockTypes.insert(blockTypes.begin(), tmp.begin(), tmp.end());
 						}
 						local->addExternalRows(blockTypes);
 						if (sender_.isActive()) {
+							// The moves made before the rows must arrive before.
+							localConnection_.sendMoves();
 							net::Packet packet;
 							packet << PacketType::PLAYER_TETRIS;
 							packet << localConnection_.getId();
 							packet << local->getId();
 							for (auto blockType : blockTypes) {
-								packet << localConnection_.getId();
+								packet << blockType;
 							}
 							sender_.sendToAll(packet);
 						}
@@ -544,6 +609,18 @@ void TetrisGame::Sender::sendToAllExcept(std::shared_ptr<RemoteConnection> remot
 	}
 }
 
+int TetrisGame::Sender::getEncodingVersion() const {
+	if (remoteConnections_.empty()) {
+		// Nothing is known about the server yet.
+		return connectionToServer_ ? 0 : ENCODING_VERSION;
+	}
+	int version = ENCODING_VERSION;
+	for (auto& remote : remoteConnections_) {
+		version = std::min(version, remote->getEncodingVersion());
+	}
+	return version;
+}
+
 std::shared_ptr<RemoteConnection> TetrisGame::Sender::findRemoteConnection(int connectionId) {
 	auto it = std::find_if(remoteConnections_.begin(), remoteConnections_.end(),
 		[connectionId](const std::shared_ptr<RemoteConnection>& remote) {
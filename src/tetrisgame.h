@@ -2,9 +2,11 @@
 #define TETRISGAME_H
 
 #include "protocol.h"
+#include "boardsync.h"
 #include "localconnection.h"
 #include "remoteconnection.h"
 #include "device.h"
+#include "gamesnapshot.h"
 
 #include <mw/signal.h>
 
@@ -70,6 +72,31 @@ public:
 		return maxLevel_;
 	}
 
+	// The way the blocks are generated, used from the next game.
+	void setBlockGeneratorMode(BlockGenerator::Mode mode) {
+		localConnection_.setBlockGeneratorMode(mode);
+	}
+
+	// Save the positions of all local players to the corpus, null to stop saving.
+	void setBoardCorpusWriter(const std::shared_ptr<BoardCorpusWriter>& boardCorpusWriter) {
+		localConnection_.setBoardCorpusWriter(boardCorpusWriter);
+	}
+
+	// Record the games of all local players, null to stop recording.
+	void setReplayWriter(const std::shared_ptr<ReplayWriter>& replayWriter) {
+		localConnection_.setReplayWriter(replayWriter);
+	}
+
+	// The moves sent to the other connections.
+	const MoveStatistics& getMoveStatistics() const {
+		return localConnection_.getMoveStatistics();
+	}
+
+	// The board snapshots sent to the other connections, and the remote boards found to differ.
+	const SyncStatistics& getSyncStatistics() const {
+		return boardSync_.getStatistics();
+	}
+
 	void setCountDownTime(int countDownTime) {
 		countDownTime_ = countDownTime;
 	}
@@ -104,6 +131,9 @@ public:
 		return nbrOfPlayers_ > 1 && countDownTime_ > 0;
 	}
 
+	// Copy the state of all players, the vectors in the snapshot are reused.
+	void createSnapshot(GameSnapshot& snapshot) const;
+
 private:
 	class Sender : public PacketSender {
 	public:
@@ -113,6 +143,9 @@ private:
 
 		void sendToAllExcept(std::shared_ptr<RemoteConnection> remoteSendNot, const net::Packet& packet) const;
 
+		// The newest packet encoding known by all connections.
+		int getEncodingVersion() const;
+
 		std::shared_ptr<RemoteConnection> findRemoteConnection(int connectionId);
 
 		std::shared_ptr<RemoteConnection> addRemoteConnection(int connectionId, net::ConnectionPtr connection);
@@ -166,6 +199,8 @@ private:
 
 	LocalConnection localConnection_;
 	int lastConnectionId_;
+	BoardSync boardSync_;
+	std::vector<int> connectionIds_; // Reused each update.
 
 	net::Network network_;
 
@@ -173,6 +208,8 @@ private:
 	int width_, height_, maxLevel_;
 
 	int nbrOfAlivePlayers_;
+	std::vector<std::shared_ptr<Player>> players_; // All players in the current game.
+	int games_;
 
 	int countDownTime_;   // Controlling how long the start game count down should be in seconds.
 	double timeLeftToStart_; // Time left for the count down.
@@ -24,6 +24,7 @@
 #include <sstream>
 
 TetrisWindow::TetrisWindow() : 
+	simulationThread_(tetrisGame_),
 	windowFollowMouse_(false), followMouseX_(0), followMouseY_(0),
 	nbrOfHumanPlayers_(1), nbrOfComputerPlayers_(0), startFrame_(StartFrame::MENU) {
 
@@ -34,6 +35,23 @@ TetrisWindow::TetrisWindow() :
 	Frame::setIcon(TetrisData::getInstance().getWindowIcon());
 	Frame::setBordered(TetrisData::getInstance().isWindowBordered());
 	Frame::setDefaultClosing(true);
+
+	aiService_ = std::make_shared<AiService>(TetrisData::getInstance().getAiWorkers());
+	tetrisGame_.setBlockGeneratorMode(TetrisData::getInstance().getBlockGeneratorMode());
+	const std::string boardCorpusFile = TetrisData::getInstance().getBoardCorpusFile();
+	if (!boardCorpusFile.empty()) {
+		auto boardCorpusWriter = std::make_shared<BoardCorpusWriter>();
+		if (boardCorpusWriter->open(boardCorpusFile, TETRIS_HEIGHT, TETRIS_WIDTH)) {
+			tetrisGame_.setBoardCorpusWriter(boardCorpusWriter);
+		}
+	}
+	const std::string replayFile = TetrisData::getInstance().getReplayFile();
+	if (!replayFile.empty()) {
+		auto replayWriter = std::make_shared<ReplayWriter>();
+		if (replayWriter->open(replayFile)) {
+			tetrisGame_.setReplayWriter(replayWriter);
+		}
+	}
 }
 
 void TetrisWindow::initOpenGl() {
@@ -114,10 +132,15 @@ void TetrisWindow::initPreLoop() {
 			break;
 		case StartFrame::LOCAL_GAME:
 			// Initialization local game settings.
-			tetrisGame_.createLocalGame();
+			simulationThread_.invoke([](TetrisGame& tetrisGame) {
+				tetrisGame.createLocalGame();
+			});
 			setCurrentPanel(playIndex_);
 			break;
 	}
+
+	// From now on the game is only used through the simulation thread.
+	simulationThread_.start();
 }
 
 void TetrisWindow::resumeGame() {
@@ -137,16 +160,30 @@ void TetrisWindow::resumeGame() {
 			++humans;
 		}
 	}
-	tetrisGame_.resumeGame(rows, columns, playerDataVector);
+	simulationThread_.invoke([rows, columns, playerDataVector](TetrisGame& tetrisGame) {
+		tetrisGame.resumeGame(rows, columns, playerDataVector);
+	});
 	nbrAis_->setNbr(ais);
 	nbrHumans_->setNbr(humans);
 }
 
 void TetrisWindow::saveCurrentLocalGame() {
-	if (getCurrentPanelIndex() == playIndex_ && tetrisGame_.getStatus() == TetrisGame::LOCAL) {
-		// Save only when the game is active and is a local game.
-		TetrisData::getInstance().setActiveLocalGame(tetrisGame_.getRows(), tetrisGame_.getColumns(), tetrisGame_.getPlayerData());
-		TetrisData::getInstance().save();
+	if (getCurrentPanelIndex() == playIndex_) {
+		bool local = false;
+		int rows = 0;
+		int columns = 0;
+		std::vector<PlayerData> playerData;
+		simulationThread_.invokeAndWait([&](TetrisGame& tetrisGame) {
+			local = tetrisGame.getStatus() == TetrisGame::LOCAL;
+			rows = tetrisGame.getRows();
+			columns = tetrisGame.getColumns();
+			playerData = tetrisGame.getPlayerData();
+		});
+		if (local) {
+			// Save only when the game is active and is a local game.
+			TetrisData::getInstance().setActiveLocalGame(rows, columns, playerData);
+			TetrisData::getInstance().save();
+		}
 	}
 }
 
@@ -170,6 +207,8 @@ void TetrisWindow::updateDevices(gui::Frame& frame, const SDL_Event& windowEvent
 }
 
 TetrisWindow::~TetrisWindow() {
+	// The game callbacks use the window.
+	simulationThread_.stop();
 	TetrisData::getInstance().save();
 }
 
@@ -187,7 +226,9 @@ void TetrisWindow::initMenuPanel() {
 
 	panel->addDefaultToGroup<Button>("Play", TetrisData::getInstance().getDefaultFont(30))->addActionListener([&](gui::Component&) {
 		resumeGame();
-		tetrisGame_.pause();
+		simulationThread_.invoke([](TetrisGame& tetrisGame) {
+			tetrisGame.pause();
+		});
 		setCurrentPanel(playIndex_);
 	});
 
@@ -228,22 +269,29 @@ void TetrisWindow::initPlayPanel() {
 	menu_->addActionListener([&](gui::Component&) {
 		saveCurrentLocalGame(); // Must be called first, must be in play frame.
 		setCurrentPanel(menuIndex_);
-		if (tetrisGame_.getStatus() == TetrisGame::CLIENT || tetrisGame_.getStatus() == TetrisGame::SERVER) {
-			tetrisGame_.closeGame();
-			menu_->setLabel("Menu");
-			SDL_SetWindowTitle(getSdlWindow(), "MWetris");
-		}
+		simulationThread_.invoke([&](TetrisGame& tetrisGame) {
+			if (tetrisGame.getStatus() == TetrisGame::CLIENT || tetrisGame.getStatus() == TetrisGame::SERVER) {
+				tetrisGame.closeGame();
+				simulationThread_.post([&]() {
+					menu_->setLabel("Menu");
+					SDL_SetWindowTitle(getSdlWindow(), "MWetris");
+				});
+			}
+		});
 	});
 
 	restart_ = manBar_->addDefault<Button>("Restart", TetrisData::getInstance().getDefaultFont(30));
 	restart_->addActionListener([&](gui::Component&) {
-		if (tetrisGame_.getStatus() == TetrisGame::CLIENT || tetrisGame_.getStatus() == TetrisGame::SERVER) {
-			tetrisGame_.restartGame();
-		} else {
-			tetrisGame_.closeGame();
-			setPlayers();
-			tetrisGame_.createLocalGame();
-		}
+		std::vector<DevicePtr> playerDevices = getPlayerDevices();
+		simulationThread_.invoke([playerDevices](TetrisGame& tetrisGame) {
+			if (tetrisGame.getStatus() == TetrisGame::CLIENT || tetrisGame.getStatus() == TetrisGame::SERVER) {
+				tetrisGame.restartGame();
+			} else {
+				tetrisGame.closeGame();
+				tetrisGame.setPlayers(playerDevices);
+				tetrisGame.createLocalGame();
+			}
+		});
 	});
 
 	nbrHumans_ = manBar_->addDefault<ManButton>(devices_.size(), TetrisData::getInstance().getHumanSprite(), TetrisData::getInstance().getCrossSprite());
@@ -259,16 +307,19 @@ void TetrisWindow::initPlayPanel() {
 
 	pauseButton_ = p2->addDefault<Button>("Pause", TetrisData::getInstance().getDefaultFont(30));
 	pauseButton_->addActionListener([&](gui::Component&) {
-		tetrisGame_.pause();
+		simulationThread_.invoke([](TetrisGame& tetrisGame) {
+			tetrisGame.pause();
+		});
 	});
 	
 	addDrawListener([&](gui::Frame& frame, double deltaTime) {
 		SDL_GetWindowPosition(getSdlWindow(), &lastX_, &lastY_); // Update last window position.
-		tetrisGame_.update(deltaTime);
+		// The game is updated in the simulation thread, only the changes to the window are made here.
+		simulationThread_.callPostedFunctions();
 	});
 	
     // Add the game component, already created in the constructor.
-	game_ = std::make_shared<GameComponent>(tetrisGame_);
+	game_ = std::make_shared<GameComponent>(tetrisGame_, simulationThread_);
 	add(gui::BorderLayout::CENTER, game_);
 		
 	addKeyListener([&](gui::Component& c, const SDL_Event& keyEvent) {
@@ -276,7 +327,9 @@ void TetrisWindow::initPlayPanel() {
 			case SDL_KEYDOWN:
 				switch (keyEvent.key.keysym.sym) {
 					case SDLK_F2:
-						tetrisGame_.restartGame();
+						simulationThread_.invoke([](TetrisGame& tetrisGame) {
+							tetrisGame.restartGame();
+						});
 						break;
 					case SDLK_p:
 						pauseButton_->doAction();
@@ -522,25 +575,27 @@ void TetrisWindow::initNetworkPanel() {
 		errorMessage_->setVisible(true);
 		progressBar_->setVisible(true);
 		TetrisData::getInstance().setPort(std::stoi(port_->getText()));
+		const int port = std::stoi(port_->getText());
+		nbrHumans_->setNbr(1);
+		std::vector<DevicePtr> playerDevices(devices_.begin(), devices_.begin() + nbrHumans_->getNbr());
 		if (radioButtonServer_->isSelected()) {
 			TetrisData::getInstance().save();
-			tetrisGame_.closeGame();
-			nbrHumans_->setNbr(1);
-			tetrisGame_.setPlayers(std::vector<DevicePtr>(devices_.begin(), devices_.begin() + nbrHumans_->getNbr()));
-			tetrisGame_.createServerGame(std::stoi(port_->getText()));
+			simulationThread_.invoke([playerDevices, port](TetrisGame& tetrisGame) {
+				tetrisGame.closeGame();
+				tetrisGame.setPlayers(playerDevices);
+				tetrisGame.createServerGame(port);
+			});
 		} else {
-			TetrisData::getInstance().setIp(ipClient_->getText());
+			const std::string ip = ipClient_->getText();
+			TetrisData::getInstance().setIp(ip);
 			TetrisData::getInstance().save();
-			tetrisGame_.closeGame();
-			nbrHumans_->setNbr(1);
-			tetrisGame_.setPlayers(std::vector<DevicePtr>(devices_.begin(), devices_.begin() + nbrHumans_->getNbr()));
-			tetrisGame_.createClientGame(std::stoi(port_->getText()), ipClient_->getText());
+			simulationThread_.invoke([playerDevices, port, ip](TetrisGame& tetrisGame) {
+				tetrisGame.closeGame();
+				tetrisGame.setPlayers(playerDevices);
+				tetrisGame.createClientGame(port, ip);
+			});
 		}
 	});
-
-	addDrawListener([&](gui::Frame& frame, double deltaTime) {
-		tetrisGame_.update(deltaTime);
-	});
 }
 
 void TetrisWindow::handleConnectionEvent(TetrisGameEvent& tetrisEvent) {
@@ -553,78 +608,96 @@ void TetrisWindow::handleConnectionEvent(TetrisGameEvent& tetrisEvent) {
 		
 		if (tetrisGame_.getNbrOfPlayers() == 1 &&
 			tetrisGame_.getStatus() == TetrisGame::LOCAL &&
-			tetrisGame_.getRows() == TETRIS_HEIGHT && tetrisGame_.getColumns() == TETRIS_WIDTH &&
-			highscore_->isNewRecord(localPlayer->getPoints())) {
+			tetrisGame_.getRows() == TETRIS_HEIGHT && tetrisGame_.getColumns() == TETRIS_WIDTH) {
 			// New record only in local game with default settings.
-
-			// Set points in order for highscore to know which point to save in list.
-			highscore_->setNextRecord(localPlayer->getPoints());
-			// In order for the user to insert name.
-			setCurrentPanel(newHighscoreIndex_);
+			const int points = localPlayer->getPoints();
+			simulationThread_.post([this, points]() {
+				if (highscore_->isNewRecord(points)) {
+					// Set points in order for highscore to know which point to save in list.
+					highscore_->setNextRecord(points);
+					// In order for the user to insert name.
+					setCurrentPanel(newHighscoreIndex_);
+				}
+			});
 		}
 		return;
 	} catch (std::bad_cast exp) {}
 	
 	try {
 		auto& gamePause = dynamic_cast<GamePause&>(tetrisEvent);
-		// Points high enough to be saved in the highscore list?
-		if (gamePause.pause_) {
-			pauseButton_->setLabel("Unpause");
-		} else {
-			pauseButton_->setLabel("Pause");
-		}
+		const bool pause = gamePause.pause_;
+		simulationThread_.post([this, pause]() {
+			if (pause) {
+				pauseButton_->setLabel("Unpause");
+			} else {
+				pauseButton_->setLabel("Pause");
+			}
+		});
 		return;
 	} catch (std::bad_cast exp) {}
 	
 	try {
 		auto& newConnection = dynamic_cast<NewConnection&>(tetrisEvent);
-		setCurrentPanel(playIndex_);
+		simulationThread_.post([this]() {
+			setCurrentPanel(playIndex_);
 
-		errorMessage_->setVisible(false);
-		progressBar_->setVisible(false);
+			errorMessage_->setVisible(false);
+			progressBar_->setVisible(false);
+		});
 		return;
 	} catch (std::bad_cast exp) {}
 
 	try {
 		auto& initGame = dynamic_cast<InitGame&>(tetrisEvent);
 
-		// Remove all man buttons for the old remote players.
-		for (auto& remoteManButton : remoteManButtons) {
-			manBar_->remove(remoteManButton);
-		}
-
-		// Add all man buttons for the new remote players.
+		// The number of humans and ais for each remote connection.
+		std::vector<std::pair<int, int>> remotePlayers;
 		for (auto& remoteConnection : initGame.remoteConnections_) {
-			// Show remote number of humans.
-			auto man = manBar_->addDefault<ManButton>(remoteConnection->getNbrHumanPlayers(), TetrisData::getInstance().getHumanSprite(), TetrisData::getInstance().getCrossSprite());
-			man->setNbr(remoteConnection->getNbrHumanPlayers());
-			man->setActive(false);
-			remoteManButtons.push_back(man);
-			// Show remote number of ais.
-			man = manBar_->addDefault<ManButton>(remoteConnection->getNbrAiPlayers(), TetrisData::getInstance().getComputerSprite(), TetrisData::getInstance().getCrossSprite());
-			man->setNbr(remoteConnection->getNbrAiPlayers());
-			man->setActive(false);
-			remoteManButtons.push_back(man);
+			remotePlayers.emplace_back(remoteConnection->getNbrHumanPlayers(), remoteConnection->getNbrAiPlayers());
 		}
+
+		simulationThread_.post([this, remotePlayers]() {
+			// Remove all man buttons for the old remote players.
+			for (auto& remoteManButton : remoteManButtons) {
+				manBar_->remove(remoteManButton);
+			}
+
+			// Add all man buttons for the new remote players.
+			for (const auto& players : remotePlayers) {
+				// Show remote number of humans.
+				auto man = manBar_->addDefault<ManButton>(players.first, TetrisData::getInstance().getHumanSprite(), TetrisData::getInstance().getCrossSprite());
+				man->setNbr(players.first);
+				man->setActive(false);
+				remoteManButtons.push_back(man);
+				// Show remote number of ais.
+				man = manBar_->addDefault<ManButton>(players.second, TetrisData::getInstance().getComputerSprite(), TetrisData::getInstance().getCrossSprite());
+				man->setNbr(players.second);
+				man->setActive(false);
+				remoteManButtons.push_back(man);
+			}
+		});
 		return;
 	} catch (std::bad_cast exp) {}
 	
 	try {
 		auto& start = dynamic_cast<GameStart&>(tetrisEvent);
-		switch (start.status_) {
-			case GameStart::LOCAL:
-				menu_->setLabel("Menu");
-				break;
-			case GameStart::CLIENT:
-				SDL_SetWindowTitle(getSdlWindow(), "MWetris@Client");
-				menu_->setLabel("Abort");
-				break;
-			case GameStart::SERVER:
-				SDL_SetWindowTitle(getSdlWindow(), "MWetris@Server");
-				menu_->setLabel("Abort");
-				break;
-		}
-		setCurrentPanel(playIndex_);
+		const GameStart::Status status = start.status_;
+		simulationThread_.post([this, status]() {
+			switch (status) {
+				case GameStart::LOCAL:
+					menu_->setLabel("Menu");
+					break;
+				case GameStart::CLIENT:
+					SDL_SetWindowTitle(getSdlWindow(), "MWetris@Client");
+					menu_->setLabel("Abort");
+					break;
+				case GameStart::SERVER:
+					SDL_SetWindowTitle(getSdlWindow(), "MWetris@Server");
+					menu_->setLabel("Abort");
+					break;
+			}
+			setCurrentPanel(playIndex_);
+		});
 		return;
 	} catch (std::bad_cast exp) {}
 }
@@ -646,7 +719,7 @@ void TetrisWindow::saveHighscore() {
 	TetrisData::getInstance().save();
 }
 
-void TetrisWindow::setPlayers() {
+std::vector<DevicePtr> TetrisWindow::getPlayerDevices() const {
 	std::vector<DevicePtr> playerDevices(devices_.begin(), devices_.begin() + nbrHumans_->getNbr());
 
 	for (unsigned int i = 0; i < nbrAis_->getNbr(); ++i) {
@@ -654,8 +727,14 @@ void TetrisWindow::setPlayers() {
 			playerDevices.push_back(activeAis_[i]);
 		}
 	}
-	
-	tetrisGame_.setPlayers(playerDevices);
+	return playerDevices;
+}
+
+void TetrisWindow::setPlayers() {
+	std::vector<DevicePtr> playerDevices = getPlayerDevices();
+	simulationThread_.invoke([playerDevices](TetrisGame& tetrisGame) {
+		tetrisGame.setPlayers(playerDevices);
+	});
 }
 
 DevicePtr TetrisWindow::findHumanDevice(std::string name) const {
@@ -671,10 +750,11 @@ DevicePtr TetrisWindow::findAiDevice(std::string name) const {
 	auto ais = TetrisData::getInstance().getAiVector();
 	for (const Ai& ai : ais) {
 		if (ai.getName() == name) {
-			return std::make_shared<Computer>(ai);
+			return std::make_shared<Computer>(ai, *aiService_, ai.getDepth() > 0 ? ai.getDepth() : TetrisData::getInstance().getAiDepth());
 		}
 	}
-	return std::make_shared<Computer>(ais.back());
+	const Ai& ai = ais.back();
+	return std::make_shared<Computer>(ai, *aiService_, ai.getDepth() > 0 ? ai.getDepth() : TetrisData::getInstance().getAiDepth());
 }
 
 void TetrisWindow::sdlEventListener(gui::Frame& frame, const SDL_Event& e) {
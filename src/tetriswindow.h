@@ -3,7 +3,9 @@
 
 #include "sdldevice.h"
 #include "ai.h"
+#include "aiservice.h"
 #include "tetrisgame.h"
+#include "simulationthread.h"
 
 #include <gui/frame.h>
 #include <gui/textfield.h>
@@ -46,17 +48,22 @@ private:
 
 	void updateDevices(gui::Frame& frame, const SDL_Event& windowEvent);
 
+	// Called in the simulation thread, i.e. the window is changed in posted functions.
 	void handleConnectionEvent(TetrisGameEvent& tetrisEvent);
 
 	void loadHighscore();
 	void saveHighscore();
 
+	// The devices chosen by the man buttons.
+	std::vector<DevicePtr> getPlayerDevices() const;
+
 	void setPlayers();
 
 	DevicePtr findHumanDevice(std::string name) const;
 	DevicePtr findAiDevice(std::string name) const;
 
 	TetrisGame tetrisGame_;
+	SimulationThread simulationThread_; // Declared after the game, i.e. stopped before the game is destroyed.
 
 	// initPlayPanel
 	std::shared_ptr<GameComponent> game_;
@@ -95,6 +102,7 @@ private:
 	std::vector<SdlDevicePtr> devices_;
 	int nbrOfHumanPlayers_, nbrOfComputerPlayers_;
 	std::array<DevicePtr, 4> activeAis_;
+	std::shared_ptr<AiService> aiService_;
 
 	// All panels.
 	void initMenuPanel();
@@ -0,0 +1,56 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+
+// Hands values from one writer thread to one reader thread without locks, neither
+// side waits for the other. The writer fills the back buffer and publishes it, the
+// reader always gets the latest published value. A value published again before
+// it is read is skipped.
+template <class T>
+class TripleBuffer {
+public:
+	TripleBuffer() : middle_(1), back_(2), front_(0) {
+	}
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// The buffer to fill before publish, only used by the writer. Holds an older
+	// value, not necessarily the last published one.
+	T& getBack() {
+		return buffers_[back_];
+	}
+
+	// Make the back buffer the latest value.
+	void publish() {
+		back_ = middle_.exchange(back_ | NEW_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// Move to the latest published value, return true if there was a new value.
+	// Only used by the reader.
+	bool update() {
+		if ((middle_.load(std::memory_order_relaxed) & NEW_BIT) == 0) {
+			return false;
+		}
+		front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+
+	// The value from the last update, only used by the reader.
+	const T& getFront() const {
+		return buffers_[front_];
+	}
+
+private:
+	static const int INDEX_MASK = 3;
+	static const int NEW_BIT = 4;
+
+	std::array<T, 3> buffers_;
+	std::atomic<int> middle_;
+	int back_;
+	int front_;
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,271 @@
+#include "boardsync.h"
+#include "localconnection.h"
+#include "remoteconnection.h"
+#include "protocol.h"
+
+#include <ai.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+	const int ROWS = 24;
+	const int COLUMNS = 10;
+	const double MAX_GAME_MINUTES = 10;
+	const int REMOTE_CONNECTION_ID = SERVER_CONNECTION_ID + 1;
+
+	// Plays with the ai like the computer player, but without time limits, i.e. the
+	// same moves every run.
+	class AiDevice : public Device {
+	public:
+		AiDevice() : Device(true), currentTurn_(-1) {
+		}
+
+		Input currentInput() override {
+			return input_;
+		}
+
+		std::string getName() const override {
+			return ai_.getName();
+		}
+
+		void update(const TetrisBoard& board) override {
+			if (currentTurn_ != board.getTurns()) {
+				currentTurn_ = board.getTurns();
+				latestState_ = ai_.calculateBestState(board, 1);
+				latestBlock_ = board.getBlock();
+				input_ = Input();
+			}
+			Square currentSq = board.getBlock().getRotationSquare();
+			Square sq = latestBlock_.getRotationSquare();
+			if (latestState_.left_ == sq.column_ - currentSq.column_) {
+				latestState_.left_ = 0;
+			}
+			if (latestState_.rotationLeft_ == board.getBlock().getCurrentRotation() - latestBlock_.getCurrentRotation()) {
+				latestState_.rotationLeft_ = 0;
+			}
+
+			Input input;
+			input.rotate_ = latestState_.rotationLeft_ > 0 && !input_.rotate_;
+			input.left_ = latestState_.left_ > 0;
+			input.right_ = latestState_.left_ < 0;
+			input.down_ = latestState_.left_ == 0 && latestState_.rotationLeft_ == 0;
+			input_ = input;
+		}
+
+	private:
+		Ai ai_;
+		int currentTurn_;
+		Input input_;
+		Ai::State latestState_;
+		Block latestBlock_;
+	};
+
+	// Hands the acknowledged snapshots back to the board sync of the local connection.
+	class AckSender : public PacketSender {
+	public:
+		explicit AckSender(BoardSync& boardSync) : boardSync_(boardSync) {
+		}
+
+		void sendToAll(const net::Packet& packet) const override {
+			net::Packet received = packet;
+			boardSync_.receiveAck(received);
+		}
+
+		bool isActive() const override {
+			return true;
+		}
+
+	private:
+		BoardSync& boardSync_;
+	};
+
+	// Hands the packets over to a remote connection, as if sent over the network.
+	class LoopbackSender : public PacketSender {
+	public:
+		explicit LoopbackSender(BoardSync& localBoardSync) : remote_(SERVER_CONNECTION_ID, nullptr), ackSender_(localBoardSync), bytes_(0) {
+		}
+
+		void sendToAll(const net::Packet& packet) const override {
+			bytes_ += packet.getSize();
+			net::Packet received = packet;
+			received.reset();
+			PacketType type;
+			received >> type;
+			if (type == PacketType::PLAYER_BOARD) {
+				remoteBoardSync_.receiveBoard(remote_, received, REMOTE_CONNECTION_ID, ackSender_);
+			} else {
+				remote_.receive(received);
+				for (int playerId : remote_.getDesyncedPlayers()) {
+					remoteBoardSync_.receiveDesync(remote_, playerId, REMOTE_CONNECTION_ID, ackSender_);
+				}
+				remote_.clearDesyncedPlayers();
+			}
+		}
+
+		bool isActive() const override {
+			return true;
+		}
+
+		RemoteConnection& getRemote() {
+			return remote_;
+		}
+
+		std::int64_t getBytes() const {
+			return bytes_;
+		}
+
+		const SyncStatistics& getRemoteSyncStatistics() const {
+			return remoteBoardSync_.getStatistics();
+		}
+
+	private:
+		mutable RemoteConnection remote_;
+		mutable BoardSync remoteBoardSync_;
+		mutable AckSender ackSender_;
+		mutable std::int64_t bytes_;
+	};
+
+	struct Result {
+		std::string encoding_;
+		double minutes_;
+		MoveStatistics statistics_;
+		SyncStatistics syncStatistics_;
+		SyncStatistics remoteSyncStatistics_; // Remote boards found to differ.
+		std::int64_t bytes_; // All packets.
+		int mismatches_;     // Remote boards not the same as the local boards.
+	};
+
+	// Play seeded games, with the encoding version, until the game time has passed.
+	Result play(int encodingVersion, int players, double minutes) {
+		BoardSync boardSync;
+		LoopbackSender sender(boardSync);
+		const std::vector<int> connectionIds = {REMOTE_CONNECTION_ID};
+		LocalConnection connection(sender);
+		connection.setId(SERVER_CONNECTION_ID);
+		connection.setSeed(1);
+		connection.setEncodingVersion(encodingVersion);
+
+		std::vector<DevicePtr> devices;
+		for (int i = 0; i < players; ++i) {
+			devices.push_back(std::make_shared<AiDevice>());
+		}
+		connection.setPlayers(COLUMNS, ROWS, devices);
+
+		const double timeStep = 1.0 / 60;
+		const int maxGameTicks = (int) (MAX_GAME_MINUTES * 60 / timeStep);
+		int ticks = 0;
+		int mismatches = 0;
+		while (ticks * timeStep < minutes * 60) {
+			bool gameOver = false;
+			for (int gameTicks = 0; !gameOver && gameTicks < maxGameTicks && ticks * timeStep < minutes * 60; ++gameTicks) {
+				connection.updateGame(timeStep);
+				if (encodingVersion >= SNAPSHOT_ENCODING_VERSION) {
+					boardSync.update(timeStep, connection, sender, connectionIds);
+				}
+				++ticks;
+				gameOver = true;
+				for (auto& player : connection) {
+					gameOver = gameOver && player->getTetrisBoard().isGameOver();
+				}
+			}
+
+			auto remote = sender.getRemote().begin();
+			for (auto& player : connection) {
+				const TetrisBoard& local = player->getTetrisBoard();
+				const TetrisBoard& board = (*remote++)->getTetrisBoard();
+				if (local.getBoardVector() != board.getBoardVector() || local.getNextBlockType() != board.getNextBlockType()) {
+					++mismatches;
+				}
+			}
+			connection.restart();
+		}
+
+		std::string encoding = "unbatched";
+		if (encodingVersion >= SNAPSHOT_ENCODING_VERSION) {
+			encoding = "compact with snapshots";
+		} else if (encodingVersion >= COMPACT_ENCODING_VERSION) {
+			encoding = "compact";
+		} else if (encodingVersion >= BATCH_ENCODING_VERSION) {
+			encoding = "byte";
+		}
+		return Result{encoding, ticks * timeStep / 60, connection.getMoveStatistics(), boardSync.getStatistics(),
+			sender.getRemoteSyncStatistics(), sender.getBytes(), mismatches};
+	}
+
+	void printCsv(std::ostream& stream, const std::vector<Result>& results) {
+		stream << "encoding,game minutes,moves,packets,bytes per minute,bytes per minute with a packet per move,"
+			<< "snapshots,complete snapshots,snapshot bytes per minute,desyncs,resyncs,mismatches\n";
+		for (const Result& result : results) {
+			stream << result.encoding_ << "," << std::fixed << std::setprecision(1) << result.minutes_ << ","
+				<< result.statistics_.moves_ << "," << result.statistics_.packets_ << ","
+				<< result.bytes_ / result.minutes_ << ","
+				<< (result.bytes_ + result.statistics_.getBytesSaved()) / result.minutes_ << ","
+				<< result.syncStatistics_.snapshots_ << "," << result.syncStatistics_.completeSnapshots_ << ","
+				<< result.syncStatistics_.bytes_ / result.minutes_ << ","
+				<< result.remoteSyncStatistics_.desyncs_ << "," << result.remoteSyncStatistics_.resyncs_ << ","
+				<< result.mismatches_ << "\n";
+		}
+	}
+
+	void printHelpFunction(const std::string& programName) {
+		std::cout << "Usage: " << programName << "\n";
+		std::cout << "\t" << "Measure the bytes sent per game minute by the local players, for each packet encoding.\n";
+		std::cout << "\t" << "The games are seeded and played by the ai, the result is printed as csv.\n\n";
+
+		std::cout << "Options: " << "\n";
+		std::cout << "\t-h --help                show this help\n";
+		std::cout << "\t-m --minutes             game minutes to play for each encoding\n";
+		std::cout << "\t-p --players             number of local players\n";
+		std::exit(0);
+	}
+
+} // Anonymous namespace.
+
+int main(const int argc, const char* const argv[]) {
+	std::string programName = argc > 0 ? argv[0] : "";
+	double minutes = 10;
+	int players = 2;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help") {
+			printHelpFunction(programName);
+		} else if (i + 1 >= argc) {
+			std::cerr << "Missing argument after " << arg << " flag\n";
+			std::exit(1);
+		} else if (arg == "-m" || arg == "--minutes") {
+			minutes = std::atof(argv[++i]);
+		} else if (arg == "-p" || arg == "--players") {
+			players = std::atoi(argv[++i]);
+		} else {
+			std::cerr << "Unknown flag " << arg << "\n";
+			std::exit(1);
+		}
+	}
+	if (minutes <= 0 || players <= 0) {
+		std::cerr << "The game minutes and the number of players must be positive\n";
+		return 1;
+	}
+
+	std::vector<Result> results;
+	results.push_back(play(0, players, minutes));
+	results.push_back(play(BATCH_ENCODING_VERSION, players, minutes));
+	results.push_back(play(COMPACT_ENCODING_VERSION, players, minutes));
+	results.push_back(play(SNAPSHOT_ENCODING_VERSION, players, minutes));
+	printCsv(std::cout, results);
+
+	for (const Result& result : results) {
+		if (result.mismatches_ > 0 || result.remoteSyncStatistics_.desyncs_ > 0 || result.remoteSyncStatistics_.resyncs_ > 0) {
+			std::cerr << "The remote boards differ using the " << result.encoding_ << " encoding\n";
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,97 @@
+#include "roomserver.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+	const int DEFAULT_PORT = 11155;
+	const int DEFAULT_ROOM_SIZE = 2;
+	const std::chrono::minutes STATUS_INTERVAL(1);
+
+	std::atomic<bool> quit(false);
+
+	void signalHandler(int) {
+		quit = true;
+	}
+
+	void printStatus(std::ostream& stream, const RoomServer& server) {
+		RoomStatistics statistics = server.getStatistics();
+		SyncStatistics syncStatistics = server.getSyncStatistics();
+		stream << "rooms " << server.getNbrOfRooms() << ", connections " << server.getNbrOfConnections()
+			<< ", packets " << statistics.packets_ << ", bytes " << statistics.bytes_
+			<< ", protocol errors " << statistics.protocolErrors_
+			<< ", desyncs " << syncStatistics.desyncs_ << ", resyncs " << syncStatistics.resyncs_ << std::endl;
+	}
+
+	void printHelpFunction(const std::string& programName) {
+		std::cout << "Usage: " << programName << "\n";
+		std::cout << "\t" << "Run a server without window, hosting many game rooms. The connections fill the rooms\n";
+		std::cout << "\t" << "in the order they arrive. The status is printed every minute.\n\n";
+
+		std::cout << "Options: " << "\n";
+		std::cout << "\t-h --help                show this help\n";
+		std::cout << "\t-p --port                port to listen on, default " << DEFAULT_PORT << "\n";
+		std::cout << "\t-r --room-size           connections in each room, default " << DEFAULT_ROOM_SIZE << ", at most " << GameRoom::MAX_CONNECTIONS << "\n";
+		std::cout << "\t-t --threads             worker threads updating the rooms\n";
+		std::exit(0);
+	}
+
+} // Anonymous namespace.
+
+int main(const int argc, const char* const argv[]) {
+	std::string programName = argc > 0 ? argv[0] : "";
+	int port = DEFAULT_PORT;
+	int roomSize = DEFAULT_ROOM_SIZE;
+	int threads = ThreadPool::getDefaultNbrOfWorkers();
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help") {
+			printHelpFunction(programName);
+		} else if (i + 1 >= argc) {
+			std::cerr << "Missing argument after " << arg << " flag\n";
+			std::exit(1);
+		} else if (arg == "-p" || arg == "--port") {
+			port = std::atoi(argv[++i]);
+		} else if (arg == "-r" || arg == "--room-size") {
+			roomSize = std::atoi(argv[++i]);
+		} else if (arg == "-t" || arg == "--threads") {
+			threads = std::atoi(argv[++i]);
+		} else {
+			std::cerr << "Unknown flag " << arg << "\n";
+			std::exit(1);
+		}
+	}
+	if (port <= 0 || roomSize <= 0 || threads < 0) {
+		std::cerr << "The port and the room size must be positive, and the threads not negative\n";
+		return 1;
+	}
+	if (roomSize > GameRoom::MAX_CONNECTIONS) {
+		std::cerr << "The room size must be at most " << GameRoom::MAX_CONNECTIONS << ", the connection ids are sent as one byte\n";
+		return 1;
+	}
+
+	std::signal(SIGINT, signalHandler);
+	std::signal(SIGTERM, signalHandler);
+
+	RoomServer server(roomSize, threads);
+	server.start(port);
+	std::cout << "Listening on port " << port << std::endl;
+
+	auto nextStatus = std::chrono::steady_clock::now() + STATUS_INTERVAL;
+	while (!quit) {
+		server.update();
+		if (std::chrono::steady_clock::now() >= nextStatus) {
+			nextStatus += STATUS_INTERVAL;
+			printStatus(std::cout, server);
+		}
+	}
+	server.stop();
+	printStatus(std::cout, server);
+	return 0;
+}